@@ -5,9 +5,39 @@
 
 namespace mfwu {
 
+// The placed commands behind the frames of a game, see pack_move().
+// Frame i comes from moves[ends[i - 1], ends[i]): one move for a player's
+// command, several for a robot's CommandType::BATCH. The frames past
+// num_of_frame were undone and wait for a redo.
+struct MoveLog {
+    std::vector<uint64_t> moves;
+    std::vector<size_t> ends;
+    size_t num_of_frame = 0;
+
+    void clear() {
+        moves.clear();
+        ends.clear();
+        num_of_frame = 0;
+    }
+    // a new frame drops the undone ones
+    void push_frame(const Command* cmds, size_t num) {
+        ends.resize(num_of_frame);
+        moves.resize(num_of_frame == 0 ? 0 : ends.back());
+        for (size_t i = 0; i < num; i++) {
+            moves.push_back(pack_move(cmds[i]));
+        }
+        ends.push_back(moves.size());
+        num_of_frame++;
+    }
+    size_t frame_begin(size_t frame) const {
+        return frame == 0 ? 0 : ends[frame - 1];
+    }
+    size_t frame_size(size_t frame) const {
+        return ends[frame] - frame_begin(frame);
+    }
+};  // endof struct MoveLog
+
 template <
-          size_t height_,
-          size_t width_,
           typename Seq_t=std::string, 
           typename Tbl_t=std::vector<std::vector<size_t>>
          >
@@ -16,7 +46,8 @@ public:
     using Seq_type = Seq_t;
     using Tbl_type = Tbl_t;
     static constexpr const char* dir = "./archive";
-    Archive_base(const std::string& archive_filename="") {
+    Archive_base(const std::string& archive_filename="")
+        : archive_filename_(archive_filename) {
         if (archive_filename == std::string("")) {
             std::string str = dir;
             str += '/'; 
@@ -53,10 +84,18 @@ public:
 
 
     // warning: will destroy all the frames!
-    void flush(GameStatus status) {
+    // moves: what made the frames, written after them if given
+    void flush(GameStatus status, const MoveLog* moves=nullptr) {
+        this->flush_seed();
         for (Frame& frame : this->frames_) {
             this->flush_frame(frame);
         }
+        for (size_t slot : packed_frames_) {
+            this->flush_packed_frame(slot);
+        }
+        if (moves != nullptr) {
+            this->flush_moves(*moves);
+        }
         this->flush_log(status);
         this->fs_.flush();  // flush once after a game
 
@@ -66,6 +105,42 @@ public:
     bool get_status() const {
         return status_;
     }
+    // the board seed, written ahead of the frames
+    void set_seed(uint64_t seed) {
+        seed_ = seed;
+    }
+    // Room for one 4-bit frame of height x width tiles, to be filled by
+    // Board_base::serialize_packed(), or nullptr if a frame with the same
+    // Board_base::zobrist() is stored already: the new frame then refers
+    // to it, no copy made. The arena and the index keep their capacity
+    // across games, so recording a move allocates nothing once warm.
+    // Packed frames are flushed after the text ones, use one kind a game.
+    uint8_t* new_packed_frame(size_t height, size_t width, uint64_t hash) {
+        if (slot_cnt_ == 0) {
+            packed_height_ = height;
+            packed_width_ = width;
+            packed_frame_size_ = packed_size(height, width);
+        }
+        assert(height == packed_height_ && width == packed_width_);
+        size_t& entry = find_slot(hash);
+        if (entry != 0) {
+            packed_frames_.push_back(entry - 1);
+            return nullptr;
+        }
+        entry = ++slot_cnt_;
+        slot_hash_.push_back(hash);
+        packed_frames_.push_back(slot_cnt_ - 1);
+        if (2 * slot_cnt_ > slot_index_.size()) {
+            grow_slot_index();
+        }
+        size_t offset = (slot_cnt_ - 1) * packed_frame_size_;
+        if (offset + packed_frame_size_ > packed_arena_.size()) {
+            packed_arena_.resize(std::max({offset + packed_frame_size_,
+                                           2 * packed_arena_.size(),
+                                           ARCHIVE_ARENA_INIT}));
+        }
+        return packed_arena_.data() + offset;
+    }
 
 protected:
     struct Frame {
@@ -135,12 +210,10 @@ protected:
             assert(is_seq_valid);
             tbl.clear();
             int i = 0;
-            tbl.reserve(height_);  // check
             for (int k = 0; k < seq.size(); k++) {
                 if (is_digit(seq[k])) {
                     if (i >= tbl.size()) {
                         tbl.resize(i + 1);  // check
-                        tbl[i].reserve(width_);  // check
                     }
                     tbl[i].push_back(seq[k]);
                 } else if (seq[k] == '\n') {
@@ -171,30 +244,96 @@ protected:
             << GameStatusDescription.at(static_cast<size_t>(status))
             << "\n\n";
     }
+    void flush_seed() {
+        if (!fs_.is_open()) {
+            fs_.open(archive_filename_, std::ios::app);
+        }
+        char buf[32];
+        snprintf(buf, sizeof(buf), "0x%016llx", static_cast<unsigned long long>(seed_));
+        fs_ << "[XQMS-SEED] " << buf << "\n";
+    }
+    // one line, R<row>,<col> or F<row>,<col> a move, frames split by " | "
+    void flush_moves(const MoveLog& moves) {
+        if (!fs_.is_open()) {
+            fs_.open(archive_filename_, std::ios::app);
+        }
+        text_buf_ = "[XQMS-MOVES]";
+        char buf[32];
+        for (size_t frame = 0; frame < moves.num_of_frame; frame++) {
+            if (frame > 0) { text_buf_ += " |"; }
+            for (size_t i = moves.frame_begin(frame); i < moves.ends[frame]; i++) {
+                Command cmd = unpack_move(moves.moves[i]);
+                snprintf(buf, sizeof(buf), " %c%d,%d",
+                         cmd.cmdtype == CommandType::FLAG ? 'F' : 'R', cmd.pos.row, cmd.pos.col);
+                text_buf_ += buf;
+            }
+        }
+        fs_ << text_buf_ << "\n";
+    }
     void flush_frame(Frame& frame) {
         if (!fs_.is_open()) {
             fs_.open(archive_filename_, std::ios::app);
         }
         fs_ << std::move(frame.get_seq()) << "\n";
     }
+    void flush_packed_frame(size_t slot) {
+        if (!fs_.is_open()) {
+            fs_.open(archive_filename_, std::ios::app);
+        }
+        text_buf_.resize(serialized_size(packed_height_, packed_width_));
+        unpack_cells(text_buf_.data(), packed_arena_.data() + slot * packed_frame_size_,
+                     packed_height_, packed_width_);
+        fs_ << text_buf_ << "\n";
+    }
 
     std::vector<Frame> frames_;
+    // open addressing from a frame hash to its arena slot + 1, 0 for empty
+    size_t& find_slot(uint64_t hash) {
+        if (slot_index_.empty()) {
+            grow_slot_index();
+        }
+        size_t mask = slot_index_.size() - 1;
+        size_t k = hash & mask;
+        while (slot_index_[k] != 0 && slot_hash_[slot_index_[k] - 1] != hash) {
+            k = (k + 1) & mask;
+        }
+        return slot_index_[k];
+    }
+    void grow_slot_index() {
+        slot_index_.assign(std::max<size_t>(2 * slot_index_.size(), 64), 0);
+        for (size_t slot = 0; slot < slot_cnt_; slot++) {
+            find_slot(slot_hash_[slot]) = slot + 1;
+        }
+    }
+    void clear_packed_frames() {
+        packed_frames_.clear();
+        slot_hash_.clear();
+        std::fill(slot_index_.begin(), slot_index_.end(), 0);
+        slot_cnt_ = 0;
+    }
+
+    std::vector<uint8_t> packed_arena_;
+    std::vector<size_t> packed_frames_;  // the arena slot of every frame
+    std::vector<uint64_t> slot_hash_;
+    std::vector<size_t> slot_index_;
+    size_t slot_cnt_ = 0;
+    size_t packed_height_ = 0;
+    size_t packed_width_ = 0;
+    size_t packed_frame_size_ = 0;
+    std::string text_buf_;  // one expanded frame, reused
 private:
     std::string archive_filename_;
     std::fstream fs_;
     bool status_ = true;
+    uint64_t seed_ = 0;
 };  // endof class Archive_base
 
 // always sync frames_ in record()
 template <typename ChessBoard_type>
-class Archive : public Archive_base<ChessBoard_type::height_,
-                                    ChessBoard_type::width_,
-                                    typename ChessBoard_type::ArchiveSeq_type, 
+class Archive : public Archive_base<typename ChessBoard_type::ArchiveSeq_type, 
                                     typename ChessBoard_type::ArchiveTbl_type> {
 public:
-    constexpr static const size_t height_ = ChessBoard_type::height_;
-    constexpr static const size_t width_  = ChessBoard_type::width_;
-    using base_type = Archive_base<height_, width_, typename ChessBoard_type::ArchiveSeq_type, 
+    using base_type = Archive_base<typename ChessBoard_type::ArchiveSeq_type, 
                                    typename ChessBoard_type::ArchiveTbl_type>;
     using Frame = typename base_type::Frame;
     using Seq_type = typename base_type::Seq_type;
@@ -226,21 +365,43 @@ public:
     }
     void pop_last_n_record(int num=1) override {
         for (int i = 0; i < num; i++) {
-            this->frames_.pop_back();     
+            // the slot stays, a redo finds it again
+            if (!this->packed_frames_.empty()) {
+                this->packed_frames_.pop_back();
+            } else {
+                this->frames_.pop_back();
+            }
         }
     }
 
     void init_game() override {
         this->frames_.clear();
+        this->clear_packed_frames();
         // this->frames_.emplace_back(Tbl_type(Size, typename Tbl_type::value_type(Size, 0)));
         // check: we dont need this
     }
     void init_game(const Tbl_type& board) override {
         this->frames_.clear();
+        this->clear_packed_frames();
         // this->frames_.emplace_back(board);
     }
 };  // endof class Archive
 
+// Keeps nothing and opens no file, for games nobody replays, see sim.cc
+template <typename ChessBoard_type>
+class NullArchive {
+public:
+    NullArchive(const std::string& archive_filename="") {}
+
+    void flush(GameStatus status, const MoveLog* moves=nullptr) {}
+    bool get_status() const { return true; }
+    void set_seed(uint64_t seed) {}
+    uint8_t* new_packed_frame(size_t height, size_t width, uint64_t hash) {
+        return nullptr;
+    }
+    void pop_last_n_record(int num=1) {}
+};  // endof class NullArchive
+
 }  // endof namespace mfwu
 
 #endif  // __ARCHIVE_HPP__
\ No newline at end of file
@@ -0,0 +1,318 @@
+#ifndef __BITBOARD_HPP__
+#define __BITBOARD_HPP__
+
+#include "Board.hpp"
+
+namespace mfwu {
+
+// Every layer is a bitset over the tiles in row-major order,
+// so the neighbor numbers, the flood fill and the victory check
+// are all shift / and / popcount on whole words.
+//
+// Use it like the default engine: CmdBoard<Size, BitBoard>
+template <BoardSize Size=BoardSize::Small>
+class BitBoard : public Board_base {
+public:
+    static_assert(Size != BoardSize::Custom, "BitBoard needs compile-time dimensions");
+
+    using ArchiveSeq_type = std::string;
+    using ArchiveTbl_type = std::vector<std::vector<size_t>>;
+
+    static constexpr BoardDimension dims = get_board_dimension(Size);
+    static constexpr size_t height_ = dims.height;
+    static constexpr size_t width_  = dims.width;
+    size_t height() const override { return height_; }
+    size_t width() const override { return width_; }
+    static constexpr size_t num_of_tile_ = width_ * height_;
+    static constexpr size_t num_of_mine_ = num_of_tile_ * MINE_POS_RATIO;
+
+    using layer_type = std::bitset<num_of_tile_>;
+
+    BitBoard() {
+        last_update_.reserve(num_of_tile_);
+        _init_board(fresh_seed());
+    }
+    BitBoard(const std::vector<std::vector<bool>>& mines_pos) {
+        last_update_.reserve(num_of_tile_);
+        _init_board(mines_pos);
+    }
+    BitBoard(const BitBoard& board) = default;
+    BitBoard(BitBoard&& board) = default;
+    BitBoard& operator=(const BitBoard& board) = default;
+    BitBoard& operator=(BitBoard&& board) = default;
+
+    virtual ~BitBoard() {}
+
+    void reset() override {
+        this->reseed(fresh_seed());
+    }
+    void reseed(uint64_t seed) override {
+        this->_init_board(seed);
+    }
+    uint64_t get_seed() const override {
+        return seed_;
+    }
+    uint64_t zobrist() const override {
+        return zobrist_;
+    }
+    int mines_left() const override {
+        return mine_count_down_;
+    }
+
+    void update(const Command& cmd) override {
+        size_t idx = index(cmd.pos.row, cmd.pos.col);
+        last_update_.clear();
+        if (cmd.cmdtype == CommandType::FLAG) {
+            last_update_.push_back(idx);
+            assert(covers_[idx]);
+            flags_.flip(idx);
+            visible_[idx] = flags_[idx] ? 0xF : 0xA;
+            zobrist_ ^= zobrist_key(idx, 0xF);
+            mine_count_down_ = mines_.count() - flags_.count();
+            if (mines_[idx]) {
+                log_debug("Flag a real mine");
+            } else {
+                log_debug("Flag a tile without mine");
+            }
+        } else if (cmd.cmdtype == CommandType::REVEAL) {
+            reveal(idx);
+        }
+    }
+    const std::vector<size_t>& get_last_update() const override {
+        return last_update_;
+    }
+
+    int is_end(int row, int col) const {
+        size_t idx = index(row, col);
+        if (mines_[idx] && !covers_[idx]) { return 1; }  // failures
+        if (tile_count_down_ == 0) { return 2; }  // victory
+        return 0;  // unfinished
+    }
+
+    static size_t get_height() {
+        return height_;
+    }
+    static size_t get_width() {
+        return width_;
+    }
+
+    // non-virtual access for the derived boards
+    cell_t cell(int row, int col) const {
+        return cell_at(index(row, col));
+    }
+    cell_t cell_at(size_t idx) const {
+        cell_t c = mines_[idx] ? MINE : get_num(idx);
+        if (!covers_[idx]) { c |= CELL_REVEALED; }
+        if (flags_[idx]) { c |= CELL_FLAG; }
+        return c;
+    }
+    Tile get_tile(int row, int col) const override {
+        cell_t c = cell(row, col);
+        return Tile(row, col, cell_num(c), cell_cover(c), cell_flag(c));
+    }
+    BoardView view() const override {
+        return {visible_.data(), height_, width_};
+    }
+
+    virtual void winner_display(int res) const {
+        if (res == 1) {
+            cmd_clear();
+            std::cout << "failure\n";
+        } else if (res == 2) {
+            cmd_clear();
+            std::cout << "victory\n";
+        } else {
+            assert(1 == 0);
+        }
+    }
+
+    static constexpr size_t serialized_size_ = height_ * (2 * width_ + 1);
+    static constexpr size_t packed_size_ = (num_of_tile_ + 1) / 2;
+    size_t serialized_size() const override {
+        return serialized_size_;
+    }
+    void serialize_to(char* buf) const override {
+        serialize_cells(buf, height_, width_,
+                        [this](size_t i, size_t j) { return cell(i, j); });
+    }
+    size_t packed_size() const override {
+        return packed_size_;
+    }
+    void serialize_packed(uint8_t* buf) const override {
+        pack_cells(buf, num_of_tile_, [this](size_t k) { return cell_at(k); });
+    }
+
+protected:
+    static constexpr size_t index(int row, int col) {
+        return row * width_ + col;
+    }
+
+    layer_type mines_;
+    layer_type covers_;
+    layer_type flags_;
+    // bit-sliced neighbor numbers, num = sum(num_planes_[k] << k)
+    std::array<layer_type, 4> num_planes_;
+    // tiles without mine and without neighbor mines
+    layer_type zeros_;
+    int mine_count_down_ = num_of_mine_;
+    int tile_count_down_ = num_of_tile_ - num_of_mine_;
+    std::vector<size_t> last_update_;
+    uint64_t seed_ = 0;  // 0 for a given layout
+    uint64_t zobrist_ = 0;
+    // cell_status() of every tile, kept by update(), see view()
+    std::array<uint8_t, num_of_tile_> visible_;
+
+private:
+    void _init_board(uint64_t seed) {
+        seed_ = seed;
+        log_info("Board seed: 0x%016llx", static_cast<unsigned long long>(seed_));
+        init_mines();
+        init_tile_num();
+    }
+    void _init_board(const std::vector<std::vector<bool>>& mines_pos) {
+        init_mines(mines_pos);
+        init_tile_num();
+    }
+    void init_mines() {
+        // the same layout as Board for the same seed
+        mines_.reset();
+        Xoshiro256 rng(seed_);
+        place_mines(rng, num_of_tile_, num_of_mine_,
+                    [this](size_t idx) { return mines_[idx]; },
+                    [this](size_t idx) { mines_.set(idx); });
+        if (num_of_tile_ > MINE_LOG_MAX_TILES) return ;
+        std::vector<std::vector<size_t>> mines(height_, std::vector<size_t>(width_, 0x0));
+        for (size_t k = mines_._Find_first(); k < num_of_tile_; k = mines_._Find_next(k)) {
+            mines[k / width_][k % width_] = 9;
+        }
+        CmdDisplayer<Size> mine_displayer(mines);
+        mine_displayer.log("Mines: ");
+    }
+    void init_mines(const std::vector<std::vector<bool>>& mines_pos) {
+        mines_.reset();
+        for (int i = 0; i < height_; i++) {
+            for (int j = 0; j < width_; j++) {
+                if (mines_pos[i][j]) { mines_.set(index(i, j)); }
+            }
+        }
+    }
+    void init_tile_num() {
+        // add the 8 shifted mine layers with a bit-sliced ripple adder
+        for (layer_type& plane : num_planes_) { plane.reset(); }
+        for (auto&& [inc_r, inc_c] : dirs) {
+            layer_type carry = shift(mines_, inc_r, inc_c);
+            for (layer_type& plane : num_planes_) {
+                layer_type next = plane & carry;
+                plane ^= carry;
+                carry = next;
+            }
+        }
+        zeros_ = ~(num_planes_[0] | num_planes_[1] | num_planes_[2]
+                   | num_planes_[3] | mines_);
+        covers_.set();
+        flags_.reset();
+        visible_.fill(0xA);
+        zobrist_ = 0;
+        mine_count_down_ = mines_.count();
+        tile_count_down_ = (covers_ & ~mines_).count();
+    }
+
+    int get_num(size_t idx) const {
+        return num_planes_[0][idx] | num_planes_[1][idx] << 1
+             | num_planes_[2][idx] << 2 | num_planes_[3][idx] << 3;
+    }
+
+    // cells not in the first / the last column,
+    // to keep horizontal shifts from wrapping into the next row
+    static layer_type make_col_mask(size_t col) {
+        layer_type mask;
+        mask.set();
+        for (int i = 0; i < height_; i++) {
+            mask.reset(index(i, col));
+        }
+        return mask;
+    }
+    static const layer_type& not_first_col() {
+        static const layer_type mask = make_col_mask(0);
+        return mask;
+    }
+    static const layer_type& not_last_col() {
+        static const layer_type mask = make_col_mask(width_ - 1);
+        return mask;
+    }
+    // bit i of the result is the bit of its neighbor at [inc_r, inc_c]
+    static layer_type shift(const layer_type& layer, int inc_r, int inc_c) {
+        int offset = inc_r * static_cast<int>(width_) + inc_c;
+        layer_type ret = offset >= 0 ? layer >> offset : layer << -offset;
+        if (inc_c > 0) { ret &= not_last_col(); }
+        if (inc_c < 0) { ret &= not_first_col(); }
+        return ret;
+    }
+    static layer_type dilate(const layer_type& layer) {
+        layer_type ret = layer;
+        for (auto&& [inc_r, inc_c] : dirs) {
+            ret |= shift(layer, inc_r, inc_c);
+        }
+        return ret;
+    }
+    static const std::array<layer_type, num_of_tile_>& neighbor_masks() {
+        static const std::array<layer_type, num_of_tile_> masks = [] {
+            std::array<layer_type, num_of_tile_> ret;
+            for (size_t idx = 0; idx < num_of_tile_; idx++) {
+                layer_type self;
+                self.set(idx);
+                ret[idx] = dilate(self) & ~self;
+            }
+            return ret;
+        }();
+        return masks;
+    }
+
+    void reveal(size_t idx) {
+        if (!covers_[idx]) return ;
+        layer_type region;
+        region.set(idx);
+        if (mines_[idx]) {
+            log_debug("Reveal a mine");
+        } else if (zeros_[idx]) {
+            // grow the region through zeros until it stops changing,
+            // the border numbers are picked up by the last dilation
+            while (true) {
+                layer_type grown = dilate(region & zeros_) | region;
+                if (grown == region) break;
+                region = grown;
+            }
+            assert((region & mines_).none());
+        }
+        layer_type fresh = region & covers_;
+        for (size_t k = fresh._Find_first(); k < num_of_tile_; k = fresh._Find_next(k)) {
+            last_update_.push_back(k);
+            zobrist_ ^= zobrist_key(k, visible_[k]);
+            visible_[k] = mines_[k] ? MINE : get_num(k);
+            zobrist_ ^= zobrist_key(k, visible_[k]);
+        }
+        covers_ &= ~region;
+        tile_count_down_ = (covers_ & ~mines_).count();
+    }
+
+public:
+    bool is_valid(int row, int col) const override {
+        return row >= 0 && row < height_
+               && col >= 0 && col < width_;
+    }
+    bool all_clear(const PositionPair& pp) const override {
+        return all_clear(index(pp.p1.row, pp.p1.col))
+            && all_clear(index(pp.p2.row, pp.p2.col));
+    }
+private:
+    // every covered neighbor is flagged, and the flags match the number
+    bool all_clear(size_t idx) const {
+        const layer_type& around = neighbor_masks()[idx];
+        if ((around & covers_ & ~flags_).any()) return false;
+        return (around & covers_ & flags_).count() == (mines_[idx] ? MINE : get_num(idx));
+    }
+};  // endof class BitBoard
+
+}  // endof namespace mfwu
+
+#endif  // __BITBOARD_HPP__
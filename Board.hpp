@@ -4,6 +4,9 @@
 #include "common.hpp"
 #include "Displayer.hpp"
 #include "Logger.hpp"
+#include "NeighborCount.hpp"
+#include "Random.hpp"
+#include "NoGuess.hpp"
 
 namespace mfwu {
 
@@ -17,18 +20,60 @@ public:
     virtual void show_mine_num() const = 0;
     virtual void show_without_log() const = 0;
     virtual void refresh() = 0;
+    // the board colored by mine probability, see Displayer::show_heatmap()
+    virtual void show_heatmap(const std::vector<double>& prob) const {}
     virtual void update(const Command& cmd) = 0;
+    // tiles changed by the last update(), as row * width() + col
+    virtual const std::vector<size_t>& get_last_update() const = 0;
     virtual bool is_valid(int row, int col) const = 0;
 
     virtual size_t height() const = 0;
     virtual size_t width() const = 0;
 
-    virtual std::shared_ptr<const Position> get_pos(int row, int col) const = 0;
+    // value snapshot of a tile, no allocation
+    virtual Tile get_tile(int row, int col) const = 0;
+    // every tile at once for the robots and the solvers, see BoardView,
+    // empty on a board without flat storage
+    virtual BoardView view() const { return {}; }
     virtual bool all_clear(const PositionPair& pp) const = 0;
 
+    // Take back / replay the last move, false if there is none.
+    // get_last_update() then lists the tiles that changed back.
+    virtual bool undo() { return false; }
+    virtual bool redo() { return false; }
+
+    // a new game from a fresh seed
     virtual void reset() = 0;
+    // the same seed gives the same mine layout
+    virtual void reseed(uint64_t seed) = 0;
+    virtual uint64_t get_seed() const = 0;
+    // mines not flagged yet, negative if the board has no total
+    virtual int mines_left() const { return -1; }
+    // hash of what the player sees, XOR of zobrist_key() over the tiles,
+    // equal boards hash equal across moves and games
+    virtual uint64_t zobrist() const = 0;
     virtual void winner_display(int) const = 0;
-    virtual std::string serialize() const = 0;
+
+    // frames cover frame_height() x frame_width() tiles,
+    // the whole board unless only a window of it is shown
+    virtual size_t frame_height() const { return height(); }
+    virtual size_t frame_width() const { return width(); }
+    // text frame into a caller buffer of serialized_size() bytes
+    virtual size_t serialized_size() const {
+        return mfwu::serialized_size(frame_height(), frame_width());
+    }
+    virtual void serialize_to(char* buf) const = 0;
+    // 4-bit frame into a caller buffer of packed_size() bytes
+    virtual size_t packed_size() const {
+        return mfwu::packed_size(frame_height(), frame_width());
+    }
+    virtual void serialize_packed(uint8_t* buf) const = 0;
+    // NOTE: allocates on every call, prefer serialize_to()
+    std::string serialize() const {
+        std::string ret(serialized_size(), '\0');
+        serialize_to(ret.data());
+        return ret;
+    }
     virtual int is_end(int, int) const = 0;
 
 protected:
@@ -38,27 +83,34 @@ protected:
 
 
 template <BoardSize Size=BoardSize::Small>
-class Board : public Board_base {
+class Board : public Board_base, public BoardDims<Size> {
 public:
     using ArchiveSeq_type = std::string;
     using ArchiveTbl_type = std::vector<std::vector<size_t>>;
 
-    static constexpr BoardDimension dims = get_board_dimension(Size);
-    static constexpr size_t height_ = dims.height;
-    static constexpr size_t width_  = dims.width;
+    using dims_type = BoardDims<Size>;
+    using dims_type::height_;
+    using dims_type::width_;
+    using dims_type::num_of_tile_;
+    using dims_type::num_of_mine_;
     size_t height() const override { return height_; }
     size_t width() const override { return width_; }
-    static constexpr size_t num_of_tile_ = width_ * height_;
-    static constexpr size_t num_of_mine_ = num_of_tile_ * MINE_POS_RATIO;
 
-    Board() : board_() {
-        _init_resize();
-        _init_board();        
+    Board() : dims_type(), board_() {
+        _init_storage();
+        _init_board(next_seed());
     }
-    Board(const std::vector<std::vector<bool>>& mines_pos) {
-        _init_resize();
+    Board(const std::vector<std::vector<bool>>& mines_pos) 
+        : dims_type(mines_pos.size(), mines_pos[0].size()), board_() {
+        _init_storage();
         _init_board(mines_pos);
     }
+    // runtime dimensions, for BoardSize::Custom
+    Board(size_t height, size_t width, float mine_ratio=MINE_POS_RATIO) 
+        : dims_type(height, width, mine_ratio), board_() {
+        _init_storage();
+        _init_board(next_seed());
+    }
     Board(const Board& board) = default;
     Board(Board&& board) = default;
     Board& operator=(const Board& board) = default;
@@ -66,53 +118,93 @@ public:
 
     virtual ~Board() {}
 
-    virtual void reset() {
-        this->_init_board();
-        mine_count_down_ = num_of_mine_;
-        tile_count_down_ = num_of_tile_ - num_of_mine_;
+    void reset() override {
+        this->reseed(next_seed());
+    }
+    void reseed(uint64_t seed) override {
+        this->_init_board(seed);
+    }
+    uint64_t get_seed() const override {
+        return seed_;
+    }
+    uint64_t zobrist() const override {
+        return zobrist_;
+    }
+    int mines_left() const override {
+        return mine_count_down_;
     }
 
     void update(const Command& cmd) override {
         int row = cmd.pos.row, col = cmd.pos.col;
+        last_update_.clear();
         if (cmd.cmdtype == CommandType::FLAG) {
-            assert(board_[row][col]->get_cover() == Cover::COVERED);
-            board_[row][col]->set_flag();
-            if (board_[row][col]->get_flag() == Flag::FLAG) {
+            last_update_.push_back(index(row, col));
+            const cell_t& c = board_[index(row, col)];
+            assert(cell_cover(c) == Cover::COVERED);
+            toggle(index(row, col), CELL_FLAG);
+            if (cell_flag(c) == Flag::FLAG) {
                 mine_count_down_--;
-            } else if (board_[row][col]->get_flag() == Flag::NO_FLAG) {
-                mine_count_down_++;
             } else {
-                log_warn("Invalid flag status, cannot be flagged");
-                return ;
+                mine_count_down_++;
             }
-            if (board_[row][col]->is_mine()) {
+            if (cell_is_mine(c)) {
                 log_debug("Flag a real mine");
             } else {
                 log_debug("Flag a tile without mine");
             }
         } else if (cmd.cmdtype == CommandType::REVEAL) {
-            std::unordered_set<Position, PositionHash, PositionEqual> found;
-            reveal(cmd.pos, found);
+            reveal(cmd.pos);
         }
+        journal_move(cmd.cmdtype == CommandType::FLAG ? CELL_FLAG : CELL_REVEALED);
+    }
+    const std::vector<size_t>& get_last_update() const override {
+        return last_update_;
+    }
+
+    // O(changed tiles), the board is never copied
+    bool undo() override {
+        if (move_cnt_ == 0) return false;
+        const MoveDelta& move = moves_[--move_cnt_];
+        apply_delta(move);
+        mine_count_down_ -= move.mine_delta;
+        tile_count_down_ -= move.tile_delta;
+        return true;
+    }
+    bool redo() override {
+        if (move_cnt_ == moves_.size()) return false;
+        const MoveDelta& move = moves_[move_cnt_++];
+        apply_delta(move);
+        mine_count_down_ += move.mine_delta;
+        tile_count_down_ += move.tile_delta;
+        return true;
     }
 
     // TODO: return enum
     int is_end(int row, int col) const {
-        if (board_[row][col]->is_mine() 
-            && board_[row][col]->get_cover() == Cover::REVEALED) { return 1; }  // failures
+        cell_t c = board_[index(row, col)];
+        if (cell_is_mine(c) 
+            && cell_cover(c) == Cover::REVEALED) { return 1; }  // failures
         if (tile_count_down_ == 0) { return 2; }  // victory
         return 0;  // unfinished
     }
 
-    static size_t get_height() {
+    size_t get_height() const {
         return height_;
     }
-    static size_t get_width() {
+    size_t get_width() const {
         return width_;
     }
 
-    std::shared_ptr<const Position> get_pos(int row, int col) const override {
-        return board_[row][col];
+    // non-virtual access for the derived boards
+    cell_t cell(int row, int col) const {
+        return board_[index(row, col)];
+    }
+    Tile get_tile(int row, int col) const override {
+        cell_t c = board_[index(row, col)];
+        return Tile(row, col, cell_num(c), cell_cover(c), cell_flag(c));
+    }
+    BoardView view() const override {
+        return {visible_.data(), height_, width_};
     }
     
     virtual void winner_display(int res) const {
@@ -127,210 +219,292 @@ public:
         }
     }
     
-    std::string serialize() const override {
-        std::stringstream ss;
-        for (int i = 0; i < height_; i++) {
-            for (int j = 0; j < width_; j++) {
-                if (board_[i][j]->get_cover() == Cover::COVERED) {
-                    if (board_[i][j]->get_flag() == Flag::FLAG) {
-                        ss << 'F';
-                    } else if (board_[i][j]->get_flag() == Flag::NO_FLAG) {
-                        ss << '+';
-                    } else {
-                        ss << '?';
-                    }
-                } else if (board_[i][j]->get_cover() == Cover::REVEALED) {
-                    if (board_[i][j]->get_num() == 9) {
-                        ss << 'X';
-                    } else if (board_[i][j]->get_num() >= 0 
-                               and board_[i][j]->get_num() < 9) {
-                        ss << char('0' + board_[i][j]->get_num());
-                    } else {
-                        ss << '?';
-                    }
-                } else {
-                    ss << '?';
-                }
-                ss << ' ';
-            }
-            ss << '\n';
-        }
-        return ss.str();
+    size_t serialized_size() const override {
+        return dims_type::serialized_size_;
+    }
+    void serialize_to(char* buf) const override {
+        serialize_cells(buf, height_, width_,
+                        [this](size_t i, size_t j) { return board_[index(i, j)]; });
+    }
+    size_t packed_size() const override {
+        return dims_type::packed_size_;
+    }
+    void serialize_packed(uint8_t* buf) const override {
+        pack_cells(buf, num_of_tile_, [this](size_t k) { return board_[k]; });
     }
 
 protected:
-    std::vector<std::vector<std::shared_ptr<Position>>> board_;
+    size_t index(int row, int col) const {
+        return row * width_ + col;
+    }
+
+    // row-major, one byte per tile, see cell_t
+    tile_storage_t<Size, cell_t> board_;
+    // cell_status() of board_, kept by toggle(), see view()
+    tile_storage_t<Size, uint8_t> visible_;
     int mine_count_down_ = num_of_mine_;
     int tile_count_down_ = num_of_tile_ - num_of_mine_;
-    
+    std::vector<size_t> last_update_;
+    uint64_t seed_ = 0;  // 0 for a given layout
+    uint64_t zobrist_ = 0;  // kept up to date by toggle()
+    // no-guess layouts start with start_ revealed, see NoGuess.hpp
+    bool no_guess_ = false;
+    size_t start_ = 0;
+
+    // A move only ever toggles one bit, CELL_FLAG or CELL_REVEALED,
+    // on the tiles it changed, so toggling it again undoes the move
+    // and toggling once more redoes it.
+    struct MoveDelta {
+        size_t begin;  // tiles in journal_[begin, end)
+        size_t end;
+        cell_t mask;
+        int mine_delta;
+        int tile_delta;
+    };  // endof struct MoveDelta
+    std::vector<tile_index_t<Size>> journal_;
+    std::vector<MoveDelta> moves_;
+    size_t move_cnt_ = 0;  // moves_[move_cnt_, ) are undone, ready to redo
+
 
 private:
-    void _init_resize() {
-        board_.resize(height_);
-        for (int i = 0; i < height_; i++) {
-            board_[i].resize(width_);
+    void _init_storage() {
+        resize_storage(board_, num_of_tile_);
+        resize_storage(visible_, num_of_tile_);
+        resize_storage(reveal_stack_, num_of_tile_);
+        scratch_.resize(neighbor_scratch_size(height_, width_));
+        last_update_.reserve(num_of_tile_);
+        journal_.reserve(num_of_tile_);
+        no_guess_ = no_guess_mode() 
+                    && num_of_tile_ <= NO_GUESS_MAX_TILES
+                    && num_of_mine_ + 9 <= num_of_tile_;
+        if (no_guess_mode() && !no_guess_) {
+            log_warn("no-guess mode is off for this board: too large or too dense");
         }
     }
-    void _init_board() {
+    // the pool usually has a verified one ready, see NoGuess.hpp
+    uint64_t next_seed() const {
+        return no_guess_ ? no_guess_seed(height_, width_, num_of_mine_) : fresh_seed();
+    }
+    void _init_board(uint64_t seed) {
+        seed_ = seed;
+        log_info("Board seed: 0x%016llx", static_cast<unsigned long long>(seed_));
         init_mines();
         init_tile_num();
+        mine_count_down_ = num_of_mine_;
+        tile_count_down_ = num_of_tile_ - num_of_mine_;
+        clear_journal();
+        zobrist_ = 0;
+        std::fill(visible_.begin(), visible_.end(), 0xA);
+        if (no_guess_) {
+            last_update_.clear();
+            reveal({static_cast<int>(start_ / width_), static_cast<int>(start_ % width_)});
+            log_info("No-guess start: [%lu, %lu]", start_ / width_, start_ % width_);
+        }
     }
     void _init_board(const std::vector<std::vector<bool>>& mines_pos) {
         init_mines(mines_pos);
         init_tile_num();
+        clear_journal();
+        zobrist_ = 0;
+        std::fill(visible_.begin(), visible_.end(), 0xA);
     }
     void init_mines() {
-        // randomly mining
-        // 不重复的随机序列
-        std::unordered_set<size_t> mines_pos = get_random_mines();
+        // randomly mining, board_ itself is the bitmap
+        std::fill(board_.begin(), board_.end(), 0);
+        Xoshiro256 rng(seed_);
+        if (no_guess_) {
+            start_ = place_mines_no_guess(rng, board_.data(), height_, width_, num_of_mine_);
+        } else {
+            place_mines(rng, num_of_tile_, num_of_mine_,
+                        [this](size_t idx) { return board_[idx] == MINE; },
+                        [this](size_t idx) { board_[idx] = MINE; });
+        }
+        if (num_of_tile_ > MINE_LOG_MAX_TILES) return ;
         std::vector<std::vector<size_t>> mines(height_, std::vector<size_t>(width_, 0x0));
-        for (int i = 0; i < height_; i++) {
-            for (int j = 0; j < width_; j++) {
-                if (mines_pos.count(i * width_ + j)) {
-                    board_[i][j] = std::make_shared<Mine>(i, j, Cover::COVERED, Flag::NO_FLAG);
-                    mines[i][j] = 9;
-                } else {
-                    board_[i][j] = std::make_shared<Tile>(i, j, 0, Cover::COVERED, Flag::NO_FLAG);
-                }
-            }
+        for (size_t idx = 0; idx < num_of_tile_; idx++) {
+            if (board_[idx] == MINE) { mines[idx / width_][idx % width_] = 9; }
         }
         CmdDisplayer<Size> mine_displayer(mines);
         mine_displayer.log("Mines: ");
     }
     void init_mines(const std::vector<std::vector<bool>>& mines_pos) {
+        int mine_cnt = 0;
         for (int i = 0; i < height_; i++) {
             for (int j = 0; j < width_; j++) {
-                if (mines_pos[i][j] == true) {
-                    board_[i][j] = std::make_shared<Mine>(i, j, Cover::COVERED, Flag::NO_FLAG);
-                } else {
-                    board_[i][j] = std::make_shared<Tile>(i, j, 0, Cover::COVERED, Flag::NO_FLAG);
-                }
+                board_[index(i, j)] = mines_pos[i][j] ? MINE : 0;
+                mine_cnt += mines_pos[i][j];
             }
         }
+        // the given layout may not hold exactly num_of_mine_ mines
+        mine_count_down_ = mine_cnt;
+        tile_count_down_ = num_of_tile_ - mine_cnt;
     }
     void init_tile_num() {
-        for (int i = 0; i < height_; i++) {
-            for (int j = 0; j < width_; j++) {
-                if (!board_[i][j]->is_mine()) {
-                    int num = count_mine_num(i, j);
-                    board_[i][j]->set_num(num);
-                }
+        // board_ holds MINE or 0 here, see NeighborCount.hpp
+        count_neighbor_mines(board_.data(), board_.data(), height_, width_, scratch_.data());
+    }
+    // Iterative flood fill, returns the number of newly revealed tiles
+    // and appends them to last_update_.
+    // The revealed bit doubles as the visit mark: a tile is revealed
+    // when it is pushed, so it is pushed at most once and the stack
+    // never holds more than num_of_tile_ entries.
+    size_t reveal(const Position& pos) {
+        size_t idx = index(pos.row, pos.col);
+        if (cell_cover(board_[idx]) == Cover::REVEALED) return 0;
+        size_t begin = last_update_.size();
+        size_t top = 0;
+        mark_revealed(idx);
+        reveal_stack_[top++] = idx;
+        while (top > 0) {
+            idx = reveal_stack_[--top];
+            cell_t c = board_[idx];
+            if (cell_is_mine(c)) {
+                log_debug("Reveal a mine");
+                continue;
             }
-        }
-    }
-    std::unordered_set<size_t> get_random_mines() {
-        std::vector<size_t> vec(num_of_tile_);
-        for (int i = 0; i < num_of_tile_; i++) {
-            vec[i] = i;
-        }
-        for (int i = 0; i < num_of_tile_; i++) {
-            int r = rand() % num_of_tile_;
-            std::swap(vec[i], vec[r]);
-        }
-        return std::unordered_set<size_t>(vec.begin(), vec.begin() + num_of_mine_);
-    }
-
-    static bool is_valid_pos(int i, int j) {
-        return i >= 0 && i < height_ && j >= 0 && j < width_;
-    }
-    int count_mine_num(int row, int col) {
-        int res = 0;
-        for (auto&& [inc_r, inc_c] : dirs) {
-            int cur_r = row + inc_r;
-            int cur_c = col + inc_c;
-            if (!is_valid_pos(cur_r, cur_c)) { continue; }
-            if (board_[cur_r][cur_c]->is_mine()) {
-                res++;
+            tile_count_down_--;
+            if (cell_num(c) != 0) continue;
+            int row = idx / width_, col = idx % width_;
+            for (auto&& [inc_r, inc_c] : dirs) {
+                int cur_r = row + inc_r,
+                    cur_c = col + inc_c;
+                if (!is_valid(cur_r, cur_c)) { continue; }
+                size_t cur = index(cur_r, cur_c);
+                if (cell_cover(board_[cur]) == Cover::REVEALED) { continue; }
+                assert(!cell_is_mine(board_[cur]));
+                mark_revealed(cur);
+                reveal_stack_[top++] = cur;
             }
         }
-        return res;
-    }
-
-    void reveal(const Position& pos, std::unordered_set<Position, PositionHash, PositionEqual>& found) {
-        if (board_[pos.row][pos.col]->get_cover() == Cover::REVEALED) return ;
-        if (found.count(pos)) { return ; }
-        else { found.insert(pos); }
-        board_[pos.row][pos.col]->reveal();
-        if (!board_[pos.row][pos.col]->is_mine()) {
-            tile_count_down_--;
-            if (board_[pos.row][pos.col]->get_num() == 0) {
-                for (auto&& [inc_r, inc_c] : dirs) {
-                    int cur_r = pos.row + inc_r,
-                        cur_c = pos.col + inc_c;
-                    if (!is_valid(cur_r, cur_c)) { continue; }
-                    assert(!board_[cur_r][cur_c]->is_mine());
-                    reveal({cur_r, cur_c}, found);
-                }
+        return last_update_.size() - begin;
+    }
+    void mark_revealed(size_t idx) {
+        toggle(idx, CELL_REVEALED);
+        last_update_.push_back(idx);
+    }
+    // every visible change goes through here to keep zobrist_ and visible_
+    void toggle(size_t idx, cell_t mask) {
+        uint8_t old = visible_[idx];
+        board_[idx] ^= mask;
+        visible_[idx] = cell_status_table()[board_[idx] & 0x3F];
+        zobrist_ ^= zobrist_key(idx, old) ^ zobrist_key(idx, visible_[idx]);
+    }
+
+    void clear_journal() {
+        journal_.clear();
+        moves_.clear();
+        move_cnt_ = 0;
+    }
+    // called after every update(), last_update_ holds the changed tiles,
+    // a new move drops whatever was undone
+    void journal_move(cell_t mask) {
+        if (last_update_.empty()) return ;
+        moves_.resize(move_cnt_);
+        journal_.resize(moves_.empty() ? 0 : moves_.back().end);
+        int mine_delta = 0, tile_delta = 0;
+        for (size_t idx : last_update_) {
+            journal_.push_back(idx);
+            if (mask == CELL_FLAG) {
+                mine_delta += cell_flag(board_[idx]) == Flag::FLAG ? -1 : 1;
+            } else if (!cell_is_mine(board_[idx])) {
+                tile_delta--;
             }
-        } else {
-            log_debug("Reveal a mine");
+        }
+        moves_.push_back({journal_.size() - last_update_.size(), journal_.size(),
+                          mask, mine_delta, tile_delta});
+        move_cnt_++;
+    }
+    void apply_delta(const MoveDelta& move) {
+        last_update_.clear();
+        for (size_t k = move.begin; k < move.end; k++) {
+            toggle(journal_[k], move.mask);
+            last_update_.push_back(journal_[k]);
         }
     }
+    tile_storage_t<Size, tile_index_t<Size>> reveal_stack_;
+    std::vector<uint8_t> scratch_;
 
+public:
     bool is_valid(int row, int col) const override {
         return row >= 0 && row < height_
                && col >= 0 && col < width_;
     }
-
-    bool all_clear(const PositionPair& pp) const {
-        int p1flag = 0, p2flag = 0;
-        for (auto&& [inc_r, inc_c] : dirs) {
-            int cur_r = pp.p1.row + inc_r,
-                cur_c = pp.p1.col + inc_c;
-            if (!is_valid(cur_r, cur_c)) { continue; }
-            if (this->board_[cur_r][cur_c]->get_cover() == Cover::COVERED) {
-                if (this->board_[cur_r][cur_c]->get_flag() == Flag::FLAG) {
-                    p1flag++;
-                } else {
-                    return false;
-                }
-            }
-        }
-        if (p1flag != this->board_[pp.p1.row][pp.p1.col]->get_num()) return false;
+    bool all_clear(const PositionPair& pp) const override {
+        return all_clear(pp.p1) && all_clear(pp.p2);
+    }
+private:
+    // every covered neighbor is flagged, and the flags match the number
+    bool all_clear(const Position& p) const {
+        int flag_cnt = 0;
         for (auto&& [inc_r, inc_c] : dirs) {
-            int cur_r = pp.p2.row + inc_r,
-                cur_c = pp.p2.col + inc_c;
+            int cur_r = p.row + inc_r,
+                cur_c = p.col + inc_c;
             if (!is_valid(cur_r, cur_c)) { continue; }
-            if (this->board_[cur_r][cur_c]->get_cover() == Cover::COVERED) {
-                if (this->board_[cur_r][cur_c]->get_flag() == Flag::FLAG) {
-                    p2flag++;
+            cell_t c = board_[index(cur_r, cur_c)];
+            if (cell_cover(c) == Cover::COVERED) {
+                if (cell_flag(c) == Flag::FLAG) {
+                    flag_cnt++;
                 } else {
                     return false;
                 }
             }
         }
-        if (p2flag != this->board_[pp.p2.row][pp.p2.col]->get_num()) return false;
-        return true;
+        return flag_cnt == cell_num(board_[index(p.row, p.col)]);
     }
 };  // endof class Board
 
-template <BoardSize Size=BoardSize::Small>
-class CmdBoard : public Board<Size> {
+// Engine: the tile storage, Board (default) or BitBoard
+template <BoardSize Size=BoardSize::Small, 
+          template <BoardSize> class Engine=Board>
+class CmdBoard final : public Engine<Size> {
 public:
-    using base_type = Board<Size>;
-    static constexpr size_t height_ = base_type::height_;
-    static constexpr size_t width_  = base_type::width_; 
-    CmdBoard() : Board<Size>(), displayer_() {}
+    using base_type = Engine<Size>;
+    using base_type::height_;
+    using base_type::width_;
+    CmdBoard() : base_type(), displayer_(this->snap()) {}
     CmdBoard(const std::vector<std::vector<bool>>& mines_pos) 
-        : Board<Size>(mines_pos),
-          displayer_(this->board_) {}
+        : base_type(mines_pos),
+          displayer_(this->snap()) {}
+    // runtime dimensions, for BoardSize::Custom
+    CmdBoard(size_t height, size_t width, float mine_ratio)
+        : base_type(height, width, mine_ratio),
+          displayer_(this->snap()) {}
     CmdBoard(const CmdBoard& board) = default;
     CmdBoard(CmdBoard&& board) = default;
     CmdBoard& operator=(const CmdBoard& board) = default;
     CmdBoard& operator=(CmdBoard&& board) = default;
 
-    virtual void reset() override {
-        base_type::reset();
-        displayer_.load_new_board();
+    void reseed(uint64_t seed) override {
+        base_type::reseed(seed);
+        // a no-guess board starts with its opening revealed
+        rebuild_displayer();
     }
 
     void update(const Command& cmd) override {
         // rm_last_sp();
         update_new_tile(cmd);
     }
+    bool undo() override {
+        if (!base_type::undo()) {
+            std::cout << HELPER_NOTHING_TO_UNDO << "\n";
+            return false;
+        }
+        update_last_tiles();
+        return true;
+    }
+    bool redo() override {
+        if (!base_type::redo()) {
+            std::cout << HELPER_NOTHING_TO_REDO << "\n";
+            return false;
+        }
+        update_last_tiles();
+        return true;
+    }
     Command get_command() override {
         std::string input_str;
         std::cout << HELPER_RETURN2MENU << "\n";
+        std::cout << HELPER_UNDO_REDO << "\n";
+        std::cout << HELPER_HINT << "\n";
         std::cout << HELPER_PLACE_TILE << "\n";
         std::cin >> input_str;
         Command ret = CmdBoard::validate_input(input_str);
@@ -356,6 +530,11 @@ public:
     void refresh() override {
         show();
     }
+    void show_heatmap(const std::vector<double>& prob) const override {
+        cmd_clear();
+        displayer_.show_heatmap(prob);
+        show_mine_num();
+    }
 
     void show_mine_num() const override {
         std::cout << "Mine num: " << this->mine_count_down_ << "\n";
@@ -364,37 +543,35 @@ public:
     // void winner_display() override {
     //     // TODO
     // }
+    // the displayer from every cell, what reseed() adds to the board's own
+    void rebuild_displayer() {
+        displayer_.update_new_tile(this->snap());
+    }
 private:
-    std::vector<std::vector<size_t>> snap() {
+    std::vector<std::vector<size_t>> snap() const {
         std::vector<std::vector<size_t>> ret(
             height_, std::vector<size_t>(width_)
         );
         for (int i = 0; i < height_; i++) {
             for (int j = 0; j < width_; j++) {
-                if (this->board_[i][j]->get_cover() == Cover::COVERED) {
-                    if (this->board_[i][j]->get_flag() == Flag::FLAG) {
-                        ret[i][j] = 0xF; continue;
-                    } else if (this->board_[i][j]->get_flag() == Flag::NO_FLAG) {
-                        ret[i][j] = 0xA; continue;
-                    }  
-                } else if (0 <= this->board_[i][j]->get_num()
-                        && 9 >= this->board_[i][j]->get_num()) {
-                    ret[i][j] = this->board_[i][j]->get_num(); continue;
-                }
-                // invalid
-                ret[i][j] = 0x3F;
+                ret[i][j] = cell_status(this->cell(i, j));
             }
         }
         return ret;
     }
     void update_new_tile(const Command& cmd) {
-        Board<Size>::update(cmd);
-        // displayer_.update_new_tile(cmd);
-        // 由于update可能会调用自己，displayer直接读取新结果
-        displayer_.update_new_tile(this->snap());
+        base_type::update(cmd);
+        update_last_tiles();
+    }
+    // only the tiles the last move changed, a flag or a revealed region
+    void update_last_tiles() {
+        for (size_t idx : this->get_last_update()) {
+            int r = idx / width_, c = idx % width_;
+            displayer_.update_tile(r, c, cell_status(this->cell(r, c)));
+        }
     }
     Command validate_input(const std::string& rstr) {
-        if (rstr.size() > 10) return Command{CommandType::INVALID, {}};
+        if (rstr.size() > 16) return Command{CommandType::INVALID, {}};
         std::string str = rstr;
         toupper(str);
         if (str == std::string(QUIT_CMD1)
@@ -408,44 +585,52 @@ private:
             return Command{CommandType::RESTART, {}};
         } else if (str == std::string(XQ4MS_CMD)) {
             return Command{CommandType::XQ4MS, {}};
+        } else if (str == std::string(UNDO_CMD1)
+            || str == std::string(UNDO_CMD2)) {
+            return Command{CommandType::UNDO, {}};
+        } else if (str == std::string(REDO_CMD1)
+            || str == std::string(REDO_CMD2)) {
+            return Command{CommandType::REDO, {}};
+        } else if (str == std::string(HINT_CMD1)
+            || str == std::string(HINT_CMD2)) {
+            return Command{CommandType::HINT, {}};
         }
 
-        if (str.size() != 3 or (str[0] != 'R' && str[0] != 'F' && str[0] != 'A'))  {
+        if (str.size() < 3 or (str[0] != 'R' && str[0] != 'F' && str[0] != 'A'))  {
             return Command{CommandType::INVALID, {}};
         }
         CommandType cmdtype = str[0] == 'F' 
                               ? CommandType::FLAG
                               : CommandType::REVEAL;
-        Position pos = {get_row(str[1]), get_col(str[2])};
+        // RAB, or R<row>,<col> for labels longer than one letter
+        size_t sep = str.find(',');
+        if (sep == std::string::npos && str.size() != 3) {
+            return Command{CommandType::INVALID, {}};
+        }
+        Position pos = sep == std::string::npos
+                     ? Position{get_row(str.substr(1, 1)), get_col(str.substr(2))}
+                     : Position{get_row(str.substr(1, sep - 1)), get_col(str.substr(sep + 1))};
         auto ret = Command{cmdtype, pos};
         if (pos.row == -1 or pos.col == -1) {
             return ret;
         }
         if ((cmdtype == CommandType::REVEAL || cmdtype == CommandType::FLAG)
-            && this->board_[pos.row][pos.col]->get_cover() == Cover::REVEALED) {
+            && cell_cover(this->cell(pos.row, pos.col)) == Cover::REVEALED) {
             ret.pos.row = ret.pos.col = -1;
             std::cout << HELPER_REVEALED_POSITION << "\n";
         }
         return ret;
     }
-    static int get_row(char c) {
-        int res = get_int(c);
-        if (res >= height_) { return -1; }
+    int get_row(const std::string& label) const {
+        int res = label2index(label);
+        if (res >= static_cast<int>(height_)) { return -1; }
         return res;
     }
-    static int get_col(char c) {
-        int res = get_int(c);
-        if (res >= width_) { return -1; }
+    int get_col(const std::string& label) const {
+        int res = label2index(label);
+        if (res >= static_cast<int>(width_)) { return -1; }
         return res;
     }
-    static int get_int(char c) {
-        if (is_lowercase(c)) {
-            return c - 'a';
-        } else if (is_uppercase(c)) {
-            return c - 'A';
-        } 
-        return -1;
-    }
     
     void show_board() const {
         displayer_.show();
@@ -457,7 +642,7 @@ private:
 };  // endof class CmdBoard
 
 template <BoardSize Size=BoardSize::Small>
-class GuiBoard : public Board<Size> {
+class GuiBoard final : public Board<Size> {
 public:
     GuiBoard() : Board<Size>() {}
     GuiBoard(const std::vector<std::vector<bool>>& mines_pos) : Board<Size>(mines_pos) {}
@@ -0,0 +1,512 @@
+#ifndef __CHUNKBOARD_HPP__
+#define __CHUNKBOARD_HPP__
+
+#include "Board.hpp"
+
+namespace mfwu {
+
+// An "infinite" board for endurance runs.
+// The world is cut into CHUNK_SIZE * CHUNK_SIZE chunks. The mines of a chunk
+// are a pure function of (seed, chunk row, chunk col), so a chunk is only
+// generated when one of its tiles is first revealed or flagged.
+// At most CHUNK_CACHE_CAPACITY chunks stay in memory: the least recently
+// used one is written to CHUNK_DIR if the player touched it, and simply
+// dropped otherwise (it regenerates from the seed).
+//
+// Coordinates are global, the terminal shows a viewport over them.
+// The robots scan the whole board, so this one is for human players.
+class ChunkBoard final : public Board_base {
+public:
+    using ArchiveSeq_type = std::string;
+    using ArchiveTbl_type = std::vector<std::vector<size_t>>;
+
+    static constexpr size_t chunk_size_  = CHUNK_SIZE;
+    static constexpr size_t chunk_tiles_ = chunk_size_ * chunk_size_;
+    static constexpr size_t height_ = CHUNK_WORLD_CHUNKS * chunk_size_;
+    static constexpr size_t width_  = CHUNK_WORLD_CHUNKS * chunk_size_;
+    static constexpr size_t view_height_ = CHUNK_VIEW_HEIGHT;
+    static constexpr size_t view_width_  = CHUNK_VIEW_WIDTH;
+    size_t height() const override { return height_; }
+    size_t width() const override { return width_; }
+
+    ChunkBoard(float mine_ratio=MINE_POS_RATIO)
+        : mine_ratio_(mine_ratio), displayer_(view_height_, view_width_) {
+        last_update_.reserve(chunk_tiles_);
+        _init_board(fresh_seed());
+    }
+    // the chunk files belong to one board
+    ChunkBoard(const ChunkBoard& board) = delete;
+    ChunkBoard& operator=(const ChunkBoard& board) = delete;
+
+    virtual ~ChunkBoard() {
+        drop_chunks();
+    }
+
+    void reset() override {
+        reseed(fresh_seed());
+    }
+    void reseed(uint64_t seed) override {
+        drop_chunks();
+        _init_board(seed);
+    }
+    uint64_t get_seed() const override {
+        return seed_;
+    }
+
+    void update(const Command& cmd) override {
+        last_update_.clear();
+        capped_at_ = 0;
+        int row = cmd.pos.row, col = cmd.pos.col;
+        if (cmd.cmdtype == CommandType::FLAG) {
+            Chunk& ch = touch_chunk(row, col);
+            cell_t& c = ch.cells[local_index(row, col)];
+            assert(cell_cover(c) == Cover::COVERED);
+            c ^= CELL_FLAG;
+            ch.dirty = true;
+            flag_cnt_ += cell_flag(c) == Flag::FLAG ? 1 : -1;
+            last_update_.push_back(index(row, col));
+        } else if (cmd.cmdtype == CommandType::REVEAL) {
+            reveal(row, col);
+        }
+        // only the changed tiles inside the view
+        for (size_t idx : last_update_) {
+            size_t r = idx / width_, c = idx % width_;
+            if (r < view_row_ || r >= view_row_ + view_height_
+                || c < view_col_ || c >= view_col_ + view_width_) { continue; }
+            displayer_.update_tile(r - view_row_, c - view_col_, cell_status(cell(r, c)));
+        }
+    }
+    const std::vector<size_t>& get_last_update() const override {
+        return last_update_;
+    }
+
+    int is_end(int row, int col) const override {
+        cell_t c = cell(row, col);
+        if (cell_is_mine(c) && cell_cover(c) == Cover::REVEALED) { return 1; }  // failures
+        return 0;  // no victory on an endless board
+    }
+
+    // not generated tiles read as covered
+    cell_t cell(int row, int col) const {
+        const Chunk* ch = find_chunk(chunk_key(row, col));
+        return ch ? ch->cells[local_index(row, col)] : 0;
+    }
+    Tile get_tile(int row, int col) const override {
+        cell_t c = cell(row, col);
+        return Tile(row, col, cell_num(c), cell_cover(c), cell_flag(c));
+    }
+
+    bool is_valid(int row, int col) const override {
+        return row >= 0 && row < height_
+               && col >= 0 && col < width_;
+    }
+
+    Command get_command() override {
+        std::string input_str;
+        std::cout << HELPER_RETURN2MENU << "\n";
+        std::cout << HELPER_PLACE_TILE << "\n";
+        std::cout << HELPER_CHUNK_MOVE_VIEW << "\n";
+        std::cin >> input_str;
+        if (!std::cin) {
+            return Command{CommandType::QUIT, {}};
+        }
+        Command ret = validate_input(input_str);
+        if (ret.cmdtype == CommandType::INVALID
+            || ((ret.cmdtype == CommandType::REVEAL ||
+                 ret.cmdtype == CommandType::FLAG)
+                && (ret.pos.row < 0 or ret.pos.col < 0))) {
+            std::cout << HELPER_INVALID_POSITION << "\n";
+            ret = this->get_command();
+        }
+        return ret;
+    }
+    void show() const override {
+        cmd_clear();
+        show_view();
+        displayer_.show();
+        show_mine_num();
+        show_capped();
+    }
+    void show_without_log() const override {
+        cmd_clear();
+        show_view();
+        displayer_.show_without_log();
+        show_mine_num();
+        show_capped();
+    }
+    void refresh() override {
+        show();
+    }
+    void show_mine_num() const override {
+        std::cout << "Flags: " << flag_cnt_
+                  << "  Revealed: " << revealed_cnt_
+                  << "  Chunks: " << chunks_.size() << " in memory, "
+                  << disk_chunks_.size() << " on disk\n";
+        log_debug("Flags: %d, revealed: %lu, chunks: %lu in memory, %lu on disk",
+                  flag_cnt_, revealed_cnt_, chunks_.size(), disk_chunks_.size());
+    }
+
+    void winner_display(int res) const override {
+        if (res == 1) {
+            cmd_clear();
+            std::cout << "failure after " << revealed_cnt_ << " tiles\n";
+        } else {
+            assert(1 == 0);
+        }
+    }
+
+    // frames are the viewport only, the whole world would not fit anywhere
+    size_t frame_height() const override { return view_height_; }
+    size_t frame_width() const override { return view_width_; }
+    // over the viewport too, computed when asked
+    uint64_t zobrist() const override {
+        uint64_t ret = 0;
+        for (size_t k = 0; k < view_height_ * view_width_; k++) {
+            ret ^= zobrist_key(k, cell_status(cell(view_row_ + k / view_width_,
+                                                   view_col_ + k % view_width_)));
+        }
+        return ret;
+    }
+    void serialize_to(char* buf) const override {
+        serialize_cells(buf, view_height_, view_width_, [this](size_t i, size_t j) {
+            return cell(view_row_ + i, view_col_ + j);
+        });
+    }
+    void serialize_packed(uint8_t* buf) const override {
+        pack_cells(buf, view_height_ * view_width_, [this](size_t k) {
+            return cell(view_row_ + k / view_width_, view_col_ + k % view_width_);
+        });
+    }
+
+private:
+    struct Chunk {
+        std::array<cell_t, chunk_tiles_> cells;
+        bool dirty = false;  // touched by the player
+        std::list<uint64_t>::iterator lru_pos;
+    };  // endof struct Chunk
+    struct ChunkKeyHash {
+        size_t operator()(uint64_t key) const {
+            return hash_position(key >> 32, key & 0xFFFFFFFFULL);
+        }
+    };  // endof struct ChunkKeyHash
+
+    void _init_board(uint64_t seed) {
+        seed_ = seed;
+        log_info("Chunk board seed: 0x%016llx", static_cast<unsigned long long>(seed_));
+        flag_cnt_ = 0;
+        revealed_cnt_ = 0;
+        capped_at_ = 0;
+        view_row_ = (height_ - view_height_) / 2;
+        view_col_ = (width_ - view_width_) / 2;
+        displayer_.load_new_board();
+    }
+
+    static uint64_t chunk_key(int row, int col) {
+        return static_cast<uint64_t>(row / chunk_size_) << 32 | (col / chunk_size_);
+    }
+    static size_t local_index(int row, int col) {
+        return (row % chunk_size_) * chunk_size_ + col % chunk_size_;
+    }
+    static size_t index(int row, int col) {
+        return static_cast<size_t>(row) * width_ + col;
+    }
+
+    // resident or on disk, nullptr if never touched
+    Chunk* find_chunk(uint64_t key) const {
+        if (last_chunk_ && last_key_ == key) return last_chunk_;
+        auto it = chunks_.find(key);
+        if (it != chunks_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second->lru_pos);
+            last_key_ = key;
+            return last_chunk_ = it->second.get();
+        }
+        if (!disk_chunks_.count(key)) return nullptr;
+        Chunk* ch = insert_chunk(key);
+        std::ifstream fin(chunk_path(key), std::ios::binary);
+        fin.read(reinterpret_cast<char*>(ch->cells.data()), chunk_tiles_);
+        if (!fin) {
+            log_error("failed to load chunk %s", chunk_path(key).c_str());
+        }
+        ch->dirty = true;
+        return ch;
+    }
+    Chunk& touch_chunk(int row, int col) {
+        uint64_t key = chunk_key(row, col);
+        Chunk* ch = find_chunk(key);
+        if (ch == nullptr) {
+            ch = insert_chunk(key);
+            generate_chunk(key, *ch);
+        }
+        return *ch;
+    }
+    Chunk* insert_chunk(uint64_t key) const {
+        if (chunks_.size() >= CHUNK_CACHE_CAPACITY) {
+            evict_chunk();
+        }
+        auto ch = std::make_unique<Chunk>();
+        lru_.push_front(key);
+        ch->lru_pos = lru_.begin();
+        last_key_ = key;
+        last_chunk_ = ch.get();
+        chunks_.emplace(key, std::move(ch));
+        return last_chunk_;
+    }
+    void evict_chunk() const {
+        uint64_t key = lru_.back();
+        lru_.pop_back();
+        auto it = chunks_.find(key);
+        if (it->second->dirty) {
+            std::filesystem::create_directories(CHUNK_DIR);
+            std::ofstream fout(chunk_path(key), std::ios::binary);
+            fout.write(reinterpret_cast<const char*>(it->second->cells.data()), chunk_tiles_);
+            if (fout) {
+                disk_chunks_.insert(key);
+            } else {
+                log_error("failed to save chunk %s", chunk_path(key).c_str());
+            }
+        }
+        if (last_chunk_ == it->second.get()) {
+            last_chunk_ = nullptr;
+        }
+        chunks_.erase(it);
+    }
+    void drop_chunks() {
+        for (uint64_t key : disk_chunks_) {
+            std::remove(chunk_path(key).c_str());
+        }
+        disk_chunks_.clear();
+        chunks_.clear();
+        lru_.clear();
+        last_chunk_ = nullptr;
+    }
+    std::string chunk_path(uint64_t key) const {
+        return std::string(CHUNK_DIR) + "/" + std::to_string(seed_)
+             + "_" + std::to_string(key >> 32) + "_" + std::to_string(key & 0xFFFFFFFFULL);
+    }
+
+    // MINE or 0 per tile, depends on nothing but (seed_, key)
+    void chunk_mines(uint64_t key, uint8_t* mines) const {
+        Xoshiro256 rng(seed_ ^ ChunkKeyHash{}(key));
+        memset(mines, 0, chunk_tiles_);
+        size_t mine_cnt = std::min<size_t>(chunk_tiles_ * mine_ratio_, chunk_tiles_);
+        place_mines(rng, chunk_tiles_, mine_cnt,
+                    [mines](size_t idx) { return mines[idx] == MINE; },
+                    [mines](size_t idx) { mines[idx] = MINE; });
+    }
+    // The numbers on the chunk border depend on the neighbor chunks,
+    // so their mines are generated too (only the mines, they stay untouched)
+    // into a one-tile ring around the chunk, see NeighborCount.hpp
+    void generate_chunk(uint64_t key, Chunk& ch) {
+        constexpr size_t pad_size = chunk_size_ + 2;
+        static thread_local std::array<uint8_t, pad_size * pad_size> pad;
+        static thread_local std::array<uint8_t, chunk_tiles_> mines;
+        static thread_local std::array<uint8_t, neighbor_scratch_size(pad_size, pad_size)> scratch;
+        pad.fill(0);
+        long chunk_row = key >> 32, chunk_col = key & 0xFFFFFFFFULL;
+        for (int dr = -1; dr <= 1; dr++) {
+            for (int dc = -1; dc <= 1; dc++) {
+                long cur_r = chunk_row + dr, cur_c = chunk_col + dc;
+                if (cur_r < 0 || cur_r >= CHUNK_WORLD_CHUNKS
+                    || cur_c < 0 || cur_c >= CHUNK_WORLD_CHUNKS) { continue; }
+                chunk_mines(static_cast<uint64_t>(cur_r) << 32 | cur_c, mines.data());
+                for (long i = 0; i < chunk_size_; i++) {
+                    long pad_r = dr * static_cast<long>(chunk_size_) + i + 1;
+                    if (pad_r < 0 || pad_r >= pad_size) { continue; }
+                    for (long j = 0; j < chunk_size_; j++) {
+                        long pad_c = dc * static_cast<long>(chunk_size_) + j + 1;
+                        if (pad_c < 0 || pad_c >= pad_size) { continue; }
+                        pad[pad_r * pad_size + pad_c] = mines[i * chunk_size_ + j];
+                    }
+                }
+            }
+        }
+        count_neighbor_mines(pad.data(), pad.data(), pad_size, pad_size, scratch.data());
+        for (size_t i = 0; i < chunk_size_; i++) {
+            memcpy(ch.cells.data() + i * chunk_size_,
+                   pad.data() + (i + 1) * pad_size + 1, chunk_size_);
+        }
+        ch.dirty = false;
+    }
+
+    // Iterative flood fill over global coordinates, so it crosses chunk
+    // borders (and generates the chunks it reaches) like any other tile.
+    // No reference into a chunk is kept across touch_chunk() calls,
+    // since loading another chunk may evict it.
+    void reveal(int row, int col) {
+        if (cell_cover(touch_chunk(row, col).cells[local_index(row, col)])
+            == Cover::REVEALED) return ;
+        reveal_stack_.clear();
+        mark_revealed(row, col);
+        reveal_stack_.emplace_back(row, col);
+        while (!reveal_stack_.empty()) {
+            Position pos = reveal_stack_.back();
+            reveal_stack_.pop_back();
+            cell_t c = touch_chunk(pos.row, pos.col).cells[local_index(pos.row, pos.col)];
+            if (cell_is_mine(c)) {
+                log_debug("Reveal a mine");
+                continue;
+            }
+            revealed_cnt_++;
+            if (cell_num(c) != 0) continue;
+            // Tiles are revealed as they are pushed, so the zeros still
+            // stacked keep covered neighbors: the player is told so,
+            // see show_capped()
+            if (last_update_.size() >= CHUNK_REVEAL_MAX) {
+                if (capped_at_ == 0) {
+                    log_warn("flood fill stops at %lu tiles", last_update_.size());
+                    capped_at_ = last_update_.size();
+                }
+                continue;
+            }
+            for (auto&& [inc_r, inc_c] : dirs) {
+                int cur_r = pos.row + inc_r,
+                    cur_c = pos.col + inc_c;
+                if (!is_valid(cur_r, cur_c)) { continue; }
+                cell_t cur = touch_chunk(cur_r, cur_c).cells[local_index(cur_r, cur_c)];
+                if (cell_cover(cur) == Cover::REVEALED) { continue; }
+                assert(!cell_is_mine(cur));
+                mark_revealed(cur_r, cur_c);
+                reveal_stack_.emplace_back(cur_r, cur_c);
+            }
+        }
+    }
+    void mark_revealed(int row, int col) {
+        Chunk& ch = touch_chunk(row, col);
+        ch.cells[local_index(row, col)] |= CELL_REVEALED;
+        ch.dirty = true;
+        last_update_.push_back(index(row, col));
+    }
+
+public:
+    bool all_clear(const PositionPair& pp) const override {
+        return all_clear(pp.p1) && all_clear(pp.p2);
+    }
+private:
+    // every covered neighbor is flagged, and the flags match the number
+    bool all_clear(const Position& p) const {
+        int flag_cnt = 0;
+        for (auto&& [inc_r, inc_c] : dirs) {
+            int cur_r = p.row + inc_r,
+                cur_c = p.col + inc_c;
+            if (!is_valid(cur_r, cur_c)) { continue; }
+            cell_t c = cell(cur_r, cur_c);
+            if (cell_cover(c) == Cover::COVERED) {
+                if (cell_flag(c) == Flag::FLAG) {
+                    flag_cnt++;
+                } else {
+                    return false;
+                }
+            }
+        }
+        return flag_cnt == cell_num(cell(p.row, p.col));
+    }
+
+    std::vector<std::vector<size_t>> snap() const {
+        std::vector<std::vector<size_t>> ret(
+            view_height_, std::vector<size_t>(view_width_)
+        );
+        for (int i = 0; i < view_height_; i++) {
+            for (int j = 0; j < view_width_; j++) {
+                ret[i][j] = cell_status(cell(view_row_ + i, view_col_ + j));
+            }
+        }
+        return ret;
+    }
+    void show_capped() const {
+        if (capped_at_ == 0) return ;
+        std::cout << HELPER_CHUNK_REVEAL_CAPPED << " (" << capped_at_ << " tiles)\n";
+    }
+    void show_view() const {
+        // numbered from the middle of the world
+        long origin_r = (height_ - view_height_) / 2,
+             origin_c = (width_ - view_width_) / 2;
+        std::cout << "View: row " << static_cast<long>(view_row_) - origin_r
+                  << ", col " << static_cast<long>(view_col_) - origin_c << "\n";
+    }
+    void move_view(int inc_r, int inc_c) {
+        long row = static_cast<long>(view_row_) + inc_r * static_cast<long>(view_height_ / 2);
+        long col = static_cast<long>(view_col_) + inc_c * static_cast<long>(view_width_ / 2);
+        view_row_ = std::clamp<long>(row, 0, height_ - view_height_);
+        view_col_ = std::clamp<long>(col, 0, width_ - view_width_);
+        displayer_.update_new_tile(snap());
+    }
+
+    Command validate_input(const std::string& rstr) {
+        if (rstr.size() > 16) return Command{CommandType::INVALID, {}};
+        std::string str = rstr;
+        toupper(str);
+        if (str == std::string(QUIT_CMD1)
+            || str == std::string(QUIT_CMD2)) {
+            return Command{CommandType::QUIT, {}};
+        } else if (str == std::string(MENU_CMD1)
+            || str == std::string(MENU_CMD2)) {
+            return Command{CommandType::MENU, {}};
+        } else if (str == std::string(RESTART_CMD1)
+            || str == std::string(RESTART_CMD2)) {
+            return Command{CommandType::RESTART, {}};
+        } else if (str == std::string(XQ4MS_CMD)) {
+            return Command{CommandType::XQ4MS, {}};
+        }
+        // moving the view is not a move, ask again
+        int inc_r = str == std::string(VIEW_UP_CMD)   ? -1
+                  : str == std::string(VIEW_DOWN_CMD) ?  1 : 0;
+        int inc_c = str == std::string(VIEW_LEFT_CMD)  ? -1
+                  : str == std::string(VIEW_RIGHT_CMD) ?  1 : 0;
+        if (inc_r != 0 || inc_c != 0) {
+            move_view(inc_r, inc_c);
+            refresh();
+            return get_command();
+        }
+
+        if (str.size() < 3 or (str[0] != 'R' && str[0] != 'F' && str[0] != 'A'))  {
+            return Command{CommandType::INVALID, {}};
+        }
+        CommandType cmdtype = str[0] == 'F'
+                              ? CommandType::FLAG
+                              : CommandType::REVEAL;
+        // labels are relative to the view
+        size_t sep = str.find(',');
+        if (sep == std::string::npos && str.size() != 3) {
+            return Command{CommandType::INVALID, {}};
+        }
+        int r = sep == std::string::npos ? label2index(str.substr(1, 1))
+                                         : label2index(str.substr(1, sep - 1));
+        int c = sep == std::string::npos ? label2index(str.substr(2))
+                                         : label2index(str.substr(sep + 1));
+        if (r < 0 || r >= view_height_ || c < 0 || c >= view_width_) {
+            return Command{cmdtype, {-1, -1}};
+        }
+        auto ret = Command{cmdtype, {static_cast<int>(view_row_) + r,
+                                     static_cast<int>(view_col_) + c}};
+        if (cell_cover(cell(ret.pos.row, ret.pos.col)) == Cover::REVEALED) {
+            ret.pos.row = ret.pos.col = -1;
+            std::cout << HELPER_REVEALED_POSITION << "\n";
+        }
+        return ret;
+    }
+
+    float mine_ratio_;
+    uint64_t seed_ = 0;
+    mutable std::unordered_map<uint64_t, std::unique_ptr<Chunk>, ChunkKeyHash> chunks_;
+    // most recently used first
+    mutable std::list<uint64_t> lru_;
+    // evicted chunks the player touched
+    mutable std::unordered_set<uint64_t> disk_chunks_;
+    // most flood fill steps stay in one chunk
+    mutable uint64_t last_key_ = 0;
+    mutable Chunk* last_chunk_ = nullptr;
+
+    int flag_cnt_ = 0;
+    size_t revealed_cnt_ = 0;
+    size_t capped_at_ = 0;  // tiles of the last flood fill, if it hit CHUNK_REVEAL_MAX
+    std::vector<Position> reveal_stack_;
+    std::vector<size_t> last_update_;
+
+    size_t view_row_ = 0;
+    size_t view_col_ = 0;
+    CmdDisplayer<BoardSize::Custom> displayer_;
+};  // endof class ChunkBoard
+
+}  // endof namespace mfwu
+
+#endif  // __CHUNKBOARD_HPP__
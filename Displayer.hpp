@@ -16,6 +16,16 @@ public:
     static constexpr const char outer_border_char = '.';
     static constexpr const char highlight_left_char = '[';
     static constexpr const char highlight_right_char = ']';
+    static constexpr const char* heat_reset = "\033[0m";
+
+    // background color of an unknown tile, see HELPER_HEATMAP_LEGEND
+    static const char* heat_color(double prob) {
+        if (prob < SOLVER_EPS) return "\033[42m";
+        if (prob < 0.25) return "\033[46m";
+        if (prob < 0.5) return "\033[43m";
+        if (prob < 1.0 - SOLVER_EPS) return "\033[45m";
+        return "\033[41m";
+    }
     
     virtual const std::vector<std::string>& get_framework() const = 0;
     // virtual void unzip_tbl(const std::string_view& str, bool mode) = 0;
@@ -33,7 +43,7 @@ static constexpr const char highlight_left_char = base_type::highlight_left_char
 static constexpr const char highlight_right_char = base_type::highlight_right_char;
 
 template <BoardSize Size>
-class Displayer : public Displayer_base {
+class Displayer : public Displayer_base, public BoardDims<Size> {
     /*  
         Mode = true:
         board: 2 * 3
@@ -47,26 +57,30 @@ class Displayer : public Displayer_base {
                      col : 2 + 2 + 3 * 2 + 1 = 2 * (3 + 3)
 
         [i, j] -> [2 + 1 * i, 4 + 2 * j]
+
+        Labels longer than one letter (more than 26 rows / cols):
+        col labels are written downwards over label_height_ rows,
+        row labels take label_width_ chars, so in general
+        [i, j] -> [label_height_ + 1 + i, 2 * (label_width_ + 1 + j)]
     */
 public:
-    static constexpr BoardDimension dims = get_board_dimension(Size);
-    static constexpr size_t height_ = dims.height;
-    static constexpr size_t width_  = dims.width;
-    static constexpr size_t num_of_tile_ = width_ * height_;
-    static constexpr size_t num_of_mine_ = num_of_tile_ * MINE_POS_RATIO;
-
-    static constexpr size_t frwk_height_ = height_ + 3;
-    static constexpr size_t frwk_width_  = 2 * (3 + width_);
+    using dims_type = BoardDims<Size>;
+    using dims_type::height_;
+    using dims_type::width_;
     using base_type = Displayer_base;
     DEFINE_SHAPES;
 
-    Displayer() : framework_(frwk_height_, std::string(frwk_width_, inner_border_char)) {
+    Displayer() : dims_type() {
         _init_framework();
         // load_empty_board();  // 和gb不同，这里不能这样初始化，因为初始的displayer并不该是empty，而是covered
         load_new_board();
     }
+    Displayer(size_t height, size_t width) : dims_type(height, width) {
+        _init_framework();
+        load_new_board();
+    }
     Displayer(const std::vector<std::vector<size_t>>& board_)
-        : framework_(frwk_height_, std::string(frwk_width_, inner_border_char)) {
+        : dims_type(board_.size(), board_[0].size()) {
         _init_framework();
         reconstruct(board_);
     }
@@ -75,16 +89,16 @@ public:
         return framework_;
     }
 
-    static size_t get_row_in_framework(int r) {
-        return 2 + r;
+    size_t get_row_in_framework(int r) const {
+        return label_height_ + 1 + r;
     }
-    static size_t get_col_in_framework(int c) {
-        return 2 * (2 + c);
+    size_t get_col_in_framework(int c) const {
+        return 2 * (label_width_ + 1 + c);
     }
     char& get_pos_ref_in_framework(int r, int c) {
         return framework_[get_row_in_framework(r)][get_col_in_framework(c)];
     }
-    static std::pair<size_t, size_t> get_pos_in_framework(int r, int c) {
+    std::pair<size_t, size_t> get_pos_in_framework(int r, int c) const {
         return {get_row_in_framework(r), get_col_in_framework(c)};
     }
 
@@ -138,6 +152,31 @@ public:
         }
         std::cout << ss.str();
     }
+    // the board with every unknown tile colored by its mine probability,
+    // prob: height * width of them, negative for the known tiles
+    void show_heatmap(const std::vector<double>& prob) const {
+        std::stringstream ss;
+        for (size_t line = 0; line < this->framework_.size(); line++) {
+            const std::string& text = this->framework_[line];
+            int i = static_cast<int>(line) - static_cast<int>(label_height_) - 1;
+            if (i < 0 || i >= static_cast<int>(height_)) {
+                ss << text << "\n";
+                continue;
+            }
+            size_t from = 0;
+            for (int j = 0; j < width_; j++) {
+                double p = prob[i * width_ + j];
+                if (p < 0.0) continue;
+                size_t col = get_col_in_framework(j);
+                ss << text.substr(from, col - from)
+                   << heat_color(p) << text[col] << heat_reset;
+                from = col + 1;
+            }
+            ss << text.substr(from) << "\n";
+        }
+        ss << HELPER_HEATMAP_LEGEND << "\n";
+        std::cout << ss.str();
+    }
     void log(std::string name="Board: ") const {
         log_debug("%s", name.c_str());
         for (const std::string& line : this->framework_) {
@@ -220,14 +259,26 @@ protected:
 
 
     std::vector<std::string> framework_;
+    size_t label_height_ = 1;
+    size_t label_width_ = 1;
 
 private:
     void _init_framework() {
+        label_height_ = label_length(width_);
+        label_width_ = label_length(height_);
+        framework_.assign(label_height_ + height_ + 2,
+                          std::string(2 * (label_width_ + 2 + width_), inner_border_char));
         for (int j = 0; j < width_; j++) {
-            framework_[0][get_col_in_framework(j)] = 'A' + j;
+            std::string label = index2label(j);
+            for (int k = 0; k < label.size(); k++) {
+                framework_[label_height_ - label.size() + k][get_col_in_framework(j)] = label[k];
+            }
         }
         for (int i = 0; i < height_; i++) {
-            framework_[get_row_in_framework(i)][0] = 'A' + i;
+            std::string label = index2label(i);
+            for (int k = 0; k < label.size(); k++) {
+                framework_[get_row_in_framework(i)][k] = label[k];
+            }
         }
         for (int j = 0; j <= width_; j++) {
             get_pos_ref_in_framework(-1, j) = outer_border_char;
@@ -256,25 +307,24 @@ private:
 
 };  // endof class Displayer
 
-#define DEFINE_SIZES \
-static constexpr size_t height_ = base_type::height_;\
-static constexpr size_t width_  = base_type::width_;\
-static constexpr size_t frwk_height_ = base_type::frwk_height_;\
-static constexpr size_t frwk_width_  = base_type::frwk_width_;
-
 template <BoardSize Size>
 class CmdDisplayer : public Displayer<Size> {
 public:
     using base_type = Displayer<Size>;
-    DEFINE_SHAPES; DEFINE_SIZES;
+    DEFINE_SHAPES;
 
     CmdDisplayer() : base_type() {}
+    CmdDisplayer(size_t height, size_t width) : base_type(height, width) {}
     CmdDisplayer(const std::vector<std::vector<size_t>>& board) : base_type(board) {}
     // TODO: BUG 25.04.22
 
     void update_new_tile(const std::vector<std::vector<size_t>>& board) {
         this->reconstruct(board);
     }
+    // patches one tile, status as in update_directly()
+    void update_tile(int r, int c, size_t status) {
+        this->update_directly(r, c, status);
+    }
 
 };  // endof class CmdDisplayer
 
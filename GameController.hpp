@@ -3,6 +3,8 @@
 
 #include "common.hpp"
 #include "Board.hpp"
+#include "BitBoard.hpp"
+#include "ChunkBoard.hpp"
 #include "Player.hpp"
 #include "Displayer.hpp"
 #include "Archive.hpp"
@@ -18,14 +20,31 @@ public:
 
 };  // endof class GameController_base
 
-template <typename Board_type, typename Player_type>
-class GameController : public GameController_base {
+// Board and player are held by their own types, so that a player of
+// Board_type, and the game loop here, call the board without a vtable;
+// only the menu in main.cc goes through GameController_base.
+// Archive_type: Archive to keep every game, NullArchive for none
+template <typename Board_type, template <typename> class Player_type,
+          typename Archive_type=Archive<Board_type>>
+class GameController final : public GameController_base {
 public:
     GameController() 
         : board_(std::make_shared<Board_type>()), 
-          player_(std::make_shared<Player_type>(board_)) {
+          player_(std::make_shared<Player_type<Board_type>>(board_)) {
         _gc_init_();
     }  // CHECK
+    // runtime dimensions, for BoardSize::Custom
+    GameController(size_t height, size_t width, float mine_ratio)
+        : board_(std::make_shared<Board_type>(height, width, mine_ratio)), 
+          player_(std::make_shared<Player_type<Board_type>>(board_)) {
+        _gc_init_();
+    }
+    // a board the caller keeps a hand on, e.g. to pick the next seed
+    GameController(std::shared_ptr<Board_type> board)
+        : board_(board),
+          player_(std::make_shared<Player_type<Board_type>>(board_)) {
+        _gc_init_();
+    }
     ~GameController() {}
 
     GameStatus start() override {
@@ -35,7 +54,9 @@ public:
         this->game_play_task(cmd_type);
         switch (cmd_type) {
         case CommandType::REVEAL : 
-        case CommandType::FLAG : {
+        case CommandType::FLAG : 
+        case CommandType::REDO : 
+        case CommandType::BATCH : {
             return GameStatus::NORMAL;
         } break;
         case CommandType::RESTART : {
@@ -56,20 +77,27 @@ public:
 
     void restart_game_init(GameStatus status) {
         log_end_game(status);
-        archive_.flush(status);
+        archive_.flush(status, &moves_);
+        moves_.clear();
         log_new_game(board_->height(), board_->width());
         board_->reset();
         player_->reset();
+        archive_.set_seed(board_->get_seed());
     }
 
     void abrupt_flush(GameStatus status) {
         log_end_game(status);
-        archive_.flush(status);
+        archive_.flush(status, &moves_);
+    }
+
+    const Player_type<Board_type>& get_player() const {
+        return *player_;
     }
 
 private:
     void _gc_init_() {
         log_info("game controller inits...");
+        archive_.set_seed(board_->get_seed());
         if (archive_.get_status() == true) {
             log_debug("archive status: online");
         } else {
@@ -85,10 +113,14 @@ private:
             cmd = this->advance();
             cmd_type = cmd.cmdtype;
             if (cmd_type != CommandType::REVEAL
-                and cmd_type != CommandType::FLAG) {
+                and cmd_type != CommandType::FLAG
+                and cmd_type != CommandType::UNDO
+                and cmd_type != CommandType::REDO
+                and cmd_type != CommandType::HINT
+                and cmd_type != CommandType::BATCH) {
                 if (cmd_type == CommandType::XQ4MS) {
                     // log_new_game();
-                    archive_.flush(GameStatus::XQ4MS);
+                    archive_.flush(GameStatus::XQ4MS, &moves_);
                     execl("./xq4ms", "xq4ms", NULL);
                     exit(0x3F3F3F3F);
                 }
@@ -98,27 +130,91 @@ private:
         board_->winner_display(res);
     }
 
+    // one refresh and one frame a command, a batch included;
+    // a move that changed nothing gets no frame, as the board
+    // journals nothing for undo() either
     Command advance() {
         Command cmd = player_->play();
         CommandType cmd_type = cmd.cmdtype;
         if (cmd_type == CommandType::FLAG
             or cmd_type == CommandType::REVEAL) {
             board_->refresh();
-            archive_.record(board_->serialize());
+            if (!board_->get_last_update().empty()) {
+                moves_.push_frame(&cmd, 1);
+                record_frame();
+            }
+        } else if (cmd_type == CommandType::BATCH) {
+            const std::vector<Command>& batch = player_->get_last_batch();
+            board_->refresh();
+            moves_.push_frame(batch.data(), batch.size());
+            record_frame();
+            log_info("Batch of %lu moves", batch.size());
+        } else if (cmd_type == CommandType::UNDO) {
+            if (undo_frame()) {
+                board_->refresh();
+                archive_.pop_last_n_record();
+            }
+        } else if (cmd_type == CommandType::REDO) {
+            if (redo_frame()) {
+                board_->refresh();
+                record_frame();
+            }
         }
         return cmd;
     }
+    // a batch is undone and redone as a whole, as it was shown
+    bool undo_frame() {
+        if (moves_.num_of_frame == 0) {
+            return board_->undo();  // tells there is nothing to undo
+        }
+        size_t num = moves_.frame_size(moves_.num_of_frame - 1);
+        for (size_t i = 0; i < num; i++) {
+            if (!board_->undo()) return false;
+        }
+        moves_.num_of_frame--;
+        return true;
+    }
+    bool redo_frame() {
+        if (moves_.num_of_frame == moves_.ends.size()) {
+            return board_->redo();  // tells there is nothing to redo
+        }
+        size_t num = moves_.frame_size(moves_.num_of_frame);
+        for (size_t i = 0; i < num; i++) {
+            if (!board_->redo()) return false;
+        }
+        moves_.num_of_frame++;
+        return true;
+    }
+
+    // a frame seen before in this game is stored once, see Archive
+    void record_frame() {
+        uint8_t* frame = archive_.new_packed_frame(
+            board_->frame_height(), board_->frame_width(), board_->zobrist());
+        if (frame != nullptr) {
+            board_->serialize_packed(frame);
+        }
+    }
 
     int check_end(Command cmd) const {
+        // a replayed move may be the last safe tile
+        if (cmd.cmdtype == CommandType::REDO) {
+            return board_->is_end(0, 0) == 2 ? 2 : 0;
+        }
+        // a batch stops at the move that ends the game
+        if (cmd.cmdtype == CommandType::BATCH) {
+            const Command& last = player_->get_last_batch().back();
+            return board_->is_end(last.pos.row, last.pos.col);
+        }
         if (cmd.cmdtype != CommandType::REVEAL) {
             return 0;
         }
         return board_->is_end(cmd.pos.row, cmd.pos.col);
     }
 
-    std::shared_ptr<Board_base> board_;
-    std::shared_ptr<Player> player_;
-    Archive<Board_type> archive_;
+    std::shared_ptr<Board_type> board_;
+    std::shared_ptr<Player_type<Board_type>> player_;
+    Archive_type archive_;
+    MoveLog moves_;
 
 };  // endof class GameController
 
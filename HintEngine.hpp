@@ -0,0 +1,165 @@
+#ifndef __HINTENGINE_HPP__
+#define __HINTENGINE_HPP__
+
+#include "common.hpp"
+#include "Solver.hpp"
+
+namespace mfwu {
+
+inline bool& hint_heatmap_setting() {
+    static bool heatmap = false;
+    return heatmap;
+}
+// \HINT also shows the board colored by mine probability
+inline void set_hint_heatmap(bool heatmap) {
+    hint_heatmap_setting() = heatmap;
+}
+inline bool hint_heatmap() {
+    return hint_heatmap_setting();
+}
+
+// What a player could key in for cmd, RAB or R<row>,<col>
+inline std::string command_text(const Command& cmd) {
+    std::string row = index2label(cmd.pos.row), col = index2label(cmd.pos.col);
+    std::string ret(1, cmd.cmdtype == CommandType::FLAG ? 'F' : 'R');
+    if (row.size() == 1 && col.size() == 1) { return ret + row + col; }
+    return ret + row + "," + col;
+}
+
+// Solves the positions a player is looking at on a thread of its own,
+// so that a hint is ready by the time it is asked for.
+//
+// Every post() gives the position a new generation; the thread always
+// takes the latest one, and a result is only kept if no newer position
+// came in meanwhile, so a hint never belongs to a stale board.
+//
+// Usage:
+//     uint64_t generation = engine.post(status, height, width, mines_left);
+//     ... the player thinks ...
+//     HintEngine::Hint hint;
+//     engine.wait(generation, hint);
+class HintEngine {
+public:
+    struct Hint {
+        Command cmd;                  // a reveal
+        double prob;                  // that it hits a mine
+        SolveResult result;           // see FrontierSolver::solve()
+        std::vector<double> heatmap;  // see FrontierSolver::prob()
+    };  // endof struct Hint
+
+    HintEngine() {
+        solver_.set_budget(std::chrono::microseconds(HINT_BUDGET_US));
+        worker_ = std::thread(&HintEngine::work, this);
+    }
+    ~HintEngine() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        posted_cv_.notify_all();
+        worker_.join();
+    }
+    HintEngine(const HintEngine&) = delete;
+    HintEngine& operator=(const HintEngine&) = delete;
+
+    // status: cell_status() codes of height * width tiles, row-major,
+    // returns the generation of this position
+    uint64_t post(const std::vector<uint8_t>& status, size_t height, size_t width,
+                  int mines_left) {
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            posted_.status = status;
+            posted_.height = height;
+            posted_.width = width;
+            posted_.mines_left = mines_left;
+            generation = ++posted_generation_;
+        }
+        posted_cv_.notify_one();
+        return generation;
+    }
+    // blocks until the hint for generation is solved, false if a newer
+    // position was posted meanwhile
+    bool wait(uint64_t generation, Hint& hint) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        solved_cv_.wait(lock, [this, generation] {
+            return solved_generation_ >= generation;
+        });
+        if (solved_generation_ != generation) { return false; }
+        hint = solved_;
+        return true;
+    }
+
+private:
+    struct Snapshot {
+        std::vector<uint8_t> status;
+        size_t height = 0;
+        size_t width = 0;
+        int mines_left = -1;
+    };  // endof struct Snapshot
+
+    void work() {
+        Snapshot cur;
+        Hint hint;
+        while (true) {
+            uint64_t generation;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                posted_cv_.wait(lock, [this] {
+                    return stop_ || posted_generation_ > solved_generation_;
+                });
+                if (stop_) return ;
+                std::swap(cur, posted_);
+                generation = posted_generation_;
+            }
+            solve(cur, hint);
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                // a newer position gets solved next, this one is dropped
+                if (generation != posted_generation_) { continue; }
+                std::swap(solved_, hint);
+                solved_generation_ = generation;
+            }
+            solved_cv_.notify_all();
+        }
+    }
+
+    // a certain safe tile if there is one, the safest guess otherwise,
+    // off the frontier on a tie
+    void solve(const Snapshot& pos, Hint& hint) {
+        size_t num_of_tile = pos.height * pos.width;
+        hint.result = solver_.solve(pos.status.data(), pos.height, pos.width, pos.mines_left);
+        hint.heatmap.assign(num_of_tile, FrontierSolver::UNKNOWN_PROB);
+        hint.cmd = {CommandType::REVEAL, {-1, -1}};
+        hint.prob = 2.0;
+        if (hint.result != SolveResult::SOLVED) return ;
+        size_t best = num_of_tile;
+        for (size_t idx = 0; idx < num_of_tile; idx++) {
+            hint.heatmap[idx] = solver_.prob(idx);
+            if (pos.status[idx] != 0xA) continue;
+            double p = solver_.prob(idx);
+            bool on_frontier = solver_.on_frontier(idx);
+            if (p < hint.prob || (p == hint.prob && !on_frontier)) {
+                hint.prob = p;
+                best = idx;
+            }
+        }
+        if (best == num_of_tile) return ;
+        hint.cmd.pos = {static_cast<int>(best / pos.width), static_cast<int>(best % pos.width)};
+    }
+
+    FrontierSolver solver_;  // the worker's only
+    std::thread worker_;
+    std::mutex mtx_;
+    std::condition_variable posted_cv_;
+    std::condition_variable solved_cv_;
+    bool stop_ = false;
+    Snapshot posted_;
+    uint64_t posted_generation_ = 0;
+    Hint solved_;
+    uint64_t solved_generation_ = 0;
+};  // endof class HintEngine
+
+}  // endof namespace mfwu
+
+#endif  // __HINTENGINE_HPP__
@@ -411,6 +411,9 @@ private:
 #endif  // __LOG_INFERENCE_ELSEWHERE__
 };  // endof class Logger
 
+// __NULL_LOG__: every log call compiles to nothing and no log file is
+// made, for headless runs such as sim.cc
+#ifndef __NULL_LOG__
 template <typename... Args>
 void log(LogLevel level, const char* fmt, Args&&... args) {
     Logger& logger = Logger::Instance();
@@ -485,6 +488,34 @@ void log_end_game(GameStatus status) {
     Logger& logger = Logger::Instance();
     logger.end_game(status);
 }
+#else  // __NULL_LOG__
+template <typename... Args>
+void log(LogLevel level, const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log(LogLevel level, time_t time_stamp, const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log_infer(size_t infer_depth, const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log_infer(time_t time_stamp, size_t infer_depth, const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log_debug(const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log_debug(time_t time_stamp, const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log_info(const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log_info(time_t time_stamp, const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log_warn(const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log_warn(time_t time_stamp, const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log_error(const char* fmt, Args&&... args) {}
+template <typename... Args>
+void log_error(time_t time_stamp, const char* fmt, Args&&... args) {}
+inline void log_new_game(size_t board_height, size_t board_width) {}
+inline void log_end_game(GameStatus status) {}
+#endif  // __NULL_LOG__
 
 
 // ---------------------------------------------
@@ -0,0 +1,200 @@
+#ifndef __NEIGHBORCOUNT_HPP__
+#define __NEIGHBORCOUNT_HPP__
+
+#include "common.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define __NEIGHBOR_COUNT_X86__
+#endif  // __x86_64__ || __i386__
+
+namespace mfwu {
+
+enum class NeighborKernel : size_t {
+    AUTO = 0,
+    SCALAR = 1,
+    SSE2 = 2,
+    AVX2 = 3
+};  // endof enum class NeighborKernel
+const std::unordered_map<size_t, std::string> NeighborKernelDescription = {
+    {0, "AUTO"}, {1, "SCALAR"}, {2, "SSE2"}, {3, "AVX2"}
+};
+
+inline bool is_kernel_supported(NeighborKernel kernel) {
+    switch (kernel) {
+    case NeighborKernel::AUTO :
+    case NeighborKernel::SCALAR : return true;
+#ifdef __NEIGHBOR_COUNT_X86__
+    case NeighborKernel::SSE2 : return __builtin_cpu_supports("sse2");
+    case NeighborKernel::AVX2 : return __builtin_cpu_supports("avx2");
+#endif  // __NEIGHBOR_COUNT_X86__
+    default : return false;
+    }
+}
+// the widest one this cpu supports
+inline NeighborKernel best_neighbor_kernel() {
+    if (is_kernel_supported(NeighborKernel::AVX2)) return NeighborKernel::AVX2;
+    if (is_kernel_supported(NeighborKernel::SSE2)) return NeighborKernel::SSE2;
+    return NeighborKernel::SCALAR;
+}
+
+inline NeighborKernel& neighbor_kernel_setting() {
+    static NeighborKernel kernel = best_neighbor_kernel();
+    return kernel;
+}
+inline NeighborKernel get_neighbor_kernel() {
+    return neighbor_kernel_setting();
+}
+// falls back to the best supported one if the cpu lacks it
+inline void set_neighbor_kernel(NeighborKernel kernel) {
+    if (kernel == NeighborKernel::AUTO || !is_kernel_supported(kernel)) {
+        kernel = best_neighbor_kernel();
+    }
+    neighbor_kernel_setting() = kernel;
+}
+
+// bytes of scratch count_neighbor_mines() needs
+constexpr size_t neighbor_scratch_size(size_t height, size_t width) {
+    return 2 * (height + 2) * (width + 2);
+}
+
+namespace neighbor_count_impl {
+
+// On a zero-padded (height + 2) * (width + 2) grid the 3x3 box sum is
+// separable, and in row-major order both passes are flat loops:
+//   hsum[k] = pad[k - 1] + pad[k] + pad[k + 1]
+//   box[k]  = hsum[k - P] + hsum[k] + hsum[k + P]     (P = width + 2)
+// the tile itself is then subtracted, and mines are set to MINE.
+// Each kernel handles [begin, end) of the flat index, tails are scalar.
+
+inline void hsum_scalar(const uint8_t* pad, uint8_t* hsum, size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++) {
+        hsum[k] = pad[k - 1] + pad[k] + pad[k + 1];
+    }
+}
+inline void box_scalar(uint8_t* pad, const uint8_t* hsum, size_t stride,
+                       size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++) {
+        uint8_t num = hsum[k - stride] + hsum[k] + hsum[k + stride] - pad[k];
+        pad[k] = pad[k] ? MINE : num;
+    }
+}
+
+#ifdef __NEIGHBOR_COUNT_X86__
+__attribute__((target("sse2")))
+inline size_t hsum_sse2(const uint8_t* pad, uint8_t* hsum, size_t begin, size_t end) {
+    size_t k = begin;
+    for (; k + 16 <= end; k += 16) {
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pad + k - 1));
+        __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pad + k));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pad + k + 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(hsum + k),
+                         _mm_add_epi8(_mm_add_epi8(l, m), r));
+    }
+    return k;
+}
+__attribute__((target("sse2")))
+inline size_t box_sse2(uint8_t* pad, const uint8_t* hsum, size_t stride,
+                       size_t begin, size_t end) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mine = _mm_set1_epi8(MINE);
+    size_t k = begin;
+    for (; k + 16 <= end; k += 16) {
+        __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hsum + k - stride));
+        __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hsum + k));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hsum + k + stride));
+        __m128i self = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pad + k));
+        __m128i num = _mm_sub_epi8(_mm_add_epi8(_mm_add_epi8(u, m), d), self);
+        __m128i is_mine = _mm_cmpgt_epi8(self, zero);
+        num = _mm_or_si128(_mm_andnot_si128(is_mine, num), _mm_and_si128(is_mine, mine));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pad + k), num);
+    }
+    return k;
+}
+
+__attribute__((target("avx2")))
+inline size_t hsum_avx2(const uint8_t* pad, uint8_t* hsum, size_t begin, size_t end) {
+    size_t k = begin;
+    for (; k + 32 <= end; k += 32) {
+        __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pad + k - 1));
+        __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pad + k));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pad + k + 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(hsum + k),
+                            _mm256_add_epi8(_mm256_add_epi8(l, m), r));
+    }
+    return k;
+}
+__attribute__((target("avx2")))
+inline size_t box_avx2(uint8_t* pad, const uint8_t* hsum, size_t stride,
+                       size_t begin, size_t end) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i mine = _mm256_set1_epi8(MINE);
+    size_t k = begin;
+    for (; k + 32 <= end; k += 32) {
+        __m256i u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hsum + k - stride));
+        __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hsum + k));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hsum + k + stride));
+        __m256i self = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pad + k));
+        __m256i num = _mm256_sub_epi8(_mm256_add_epi8(_mm256_add_epi8(u, m), d), self);
+        __m256i is_mine = _mm256_cmpgt_epi8(self, zero);
+        num = _mm256_blendv_epi8(num, mine, is_mine);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pad + k), num);
+    }
+    return k;
+}
+#endif  // __NEIGHBOR_COUNT_X86__
+
+}  // endof namespace neighbor_count_impl
+
+// Writes the 0 ~ 8 number of every tile (MINE for mines) into cells.
+// mines: height * width bytes, nonzero means mine, may alias cells
+// scratch: at least neighbor_scratch_size(height, width) bytes
+inline void count_neighbor_mines(const uint8_t* mines, uint8_t* cells,
+                                 size_t height, size_t width, uint8_t* scratch,
+                                 NeighborKernel kernel = get_neighbor_kernel()) {
+    using namespace neighbor_count_impl;
+    const size_t stride = width + 2;
+    const size_t total = (height + 2) * stride;
+    uint8_t* pad = scratch;
+    uint8_t* hsum = scratch + total;
+
+    memset(pad, 0, total);
+    for (size_t i = 0; i < height; i++) {
+        uint8_t* dst = pad + (i + 1) * stride + 1;
+        const uint8_t* src = mines + i * width;
+        for (size_t j = 0; j < width; j++) {
+            dst[j] = src[j] != 0;
+        }
+    }
+
+    // hsum is needed on rows 0 ~ height + 1, the box only on 1 ~ height
+    size_t h_begin = 1, h_end = total - 1;
+    size_t b_begin = stride, b_end = total - stride;
+    switch (kernel == NeighborKernel::AUTO ? best_neighbor_kernel() : kernel) {
+#ifdef __NEIGHBOR_COUNT_X86__
+    case NeighborKernel::AVX2 : {
+        h_begin = hsum_avx2(pad, hsum, h_begin, h_end);
+        hsum_scalar(pad, hsum, h_begin, h_end);
+        b_begin = box_avx2(pad, hsum, stride, b_begin, b_end);
+        box_scalar(pad, hsum, stride, b_begin, b_end);
+    } break;
+    case NeighborKernel::SSE2 : {
+        h_begin = hsum_sse2(pad, hsum, h_begin, h_end);
+        hsum_scalar(pad, hsum, h_begin, h_end);
+        b_begin = box_sse2(pad, hsum, stride, b_begin, b_end);
+        box_scalar(pad, hsum, stride, b_begin, b_end);
+    } break;
+#endif  // __NEIGHBOR_COUNT_X86__
+    default : {
+        hsum_scalar(pad, hsum, h_begin, h_end);
+        box_scalar(pad, hsum, stride, b_begin, b_end);
+    }
+    }
+
+    for (size_t i = 0; i < height; i++) {
+        memcpy(cells + i * width, pad + (i + 1) * stride + 1, width);
+    }
+}
+
+}  // endof namespace mfwu
+
+#endif  // __NEIGHBORCOUNT_HPP__
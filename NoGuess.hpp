@@ -0,0 +1,382 @@
+#ifndef __NOGUESS_HPP__
+#define __NOGUESS_HPP__
+
+#include "common.hpp"
+#include "NeighborCount.hpp"
+#include "Random.hpp"
+
+namespace mfwu {
+
+inline bool& no_guess_setting() {
+    static bool no_guess = false;
+    return no_guess;
+}
+// boards created afterwards only come with layouts solvable without guessing
+inline void set_no_guess_mode(bool no_guess) {
+    no_guess_setting() = no_guess;
+}
+inline bool no_guess_mode() {
+    return no_guess_setting();
+}
+
+// A no-guess candidate: the start tile is drawn first, then the mines
+// avoid it and its neighbors, so the first click always opens a region.
+// cells: height * width bytes, cleared by the caller, gets MINE or 0
+// returns the start tile
+inline size_t place_mines_no_guess(Xoshiro256& rng, cell_t* cells,
+                                   size_t height, size_t width, size_t num_of_mine) {
+    size_t num_of_tile = height * width;
+    size_t start = rng.bounded(num_of_tile);
+    int start_r = start / width, start_c = start % width;
+    // ascending, so a free slot maps to a tile by skipping them in order
+    std::array<size_t, 9> excluded;
+    size_t num_of_excluded = 0;
+    for (int i = start_r - 1; i <= start_r + 1; i++) {
+        for (int j = start_c - 1; j <= start_c + 1; j++) {
+            if (i < 0 || i >= height || j < 0 || j >= width) { continue; }
+            excluded[num_of_excluded++] = i * width + j;
+        }
+    }
+    auto to_tile = [&](size_t slot) {
+        for (size_t k = 0; k < num_of_excluded; k++) {
+            if (excluded[k] <= slot) { slot++; }
+        }
+        return slot;
+    };
+    size_t num_of_slot = num_of_tile - num_of_excluded;
+    place_mines(rng, num_of_slot, std::min(num_of_mine, num_of_slot),
+                [&](size_t slot) { return cells[to_tile(slot)] == MINE; },
+                [&](size_t slot) { cells[to_tile(slot)] = MINE; });
+    return start;
+}
+
+// Plays a fully known layout the way a careful player would, and tells
+// whether every safe tile gets revealed without a guess.
+// Rules, cheapest first:
+//   - a number whose mines are all flagged opens the rest, a number with
+//     as many covered neighbors as missing mines flags them
+//   - two numbers within distance 2: if b - a missing mines equals the
+//     tiles only b sees, those are mines and the tiles only a sees are safe
+//   - the global mine count, once nothing else applies
+// Worklist driven: a number is rechecked only when a neighbor changes.
+// Deterministic, no logging (it runs on the workers).
+class NoGuessSolver {
+public:
+    bool solve(const cell_t* cells, size_t height, size_t width, size_t start) {
+        cells_ = cells;
+        height_ = height;
+        width_ = width;
+        size_t num_of_tile = height * width;
+        state_.assign(num_of_tile, UNKNOWN);
+        in_queue_.assign(num_of_tile, 0);
+        queue_.clear();
+        pair_queue_.clear();
+        num_of_unknown_ = num_of_tile;
+        num_of_flagged_ = 0;
+        size_t num_of_mine = std::count(cells, cells + num_of_tile, MINE);
+        if (cell_is_mine(cells[start])) return false;
+        open(start);
+        while (true) {
+            if (!queue_.empty()) {
+                size_t idx = queue_.back();
+                queue_.pop_back();
+                in_queue_[idx] &= ~IN_QUEUE;
+                check(idx);
+                continue;
+            }
+            // the pair rules only once the single ones are exhausted
+            if (!pair_queue_.empty()) {
+                size_t idx = pair_queue_.back();
+                pair_queue_.pop_back();
+                in_queue_[idx] &= ~IN_PAIR_QUEUE;
+                check_pairs(idx);
+                continue;
+            }
+            if (num_of_unknown_ == 0) break;
+            // the global mine count, only decides the very end
+            size_t mines_left = num_of_mine - num_of_flagged_;
+            if (mines_left != 0 && mines_left != num_of_unknown_) break;
+            for (size_t idx = 0; idx < num_of_tile; idx++) {
+                if (state_[idx] != UNKNOWN) { continue; }
+                if (mines_left == 0) { open(idx); } else { flag(idx); }
+            }
+        }
+        return num_of_unknown_ == 0;
+    }
+
+private:
+    enum : uint8_t { UNKNOWN = 0, SAFE = 1, FLAGGED = 2 };
+    enum : uint8_t { IN_QUEUE = 1, IN_PAIR_QUEUE = 2 };
+    struct Around {
+        std::array<uint32_t, 8> unknown;
+        size_t num_of_unknown = 0;
+        int missing = 0;  // mines not flagged yet
+    };  // endof struct Around
+
+    bool is_valid(int row, int col) const {
+        return row >= 0 && row < height_ && col >= 0 && col < width_;
+    }
+    Around around(size_t idx) const {
+        Around ret;
+        int row = idx / width_, col = idx % width_;
+        ret.missing = cell_num(cells_[idx]);
+        for (auto&& [inc_r, inc_c] : dirs) {
+            int cur_r = row + inc_r, cur_c = col + inc_c;
+            if (!is_valid(cur_r, cur_c)) { continue; }
+            size_t cur = cur_r * width_ + cur_c;
+            if (state_[cur] == UNKNOWN) {
+                ret.unknown[ret.num_of_unknown++] = cur;
+            } else if (state_[cur] == FLAGGED) {
+                ret.missing--;
+            }
+        }
+        return ret;
+    }
+    static bool contains(const Around& a, uint32_t idx) {
+        for (size_t k = 0; k < a.num_of_unknown; k++) {
+            if (a.unknown[k] == idx) return true;
+        }
+        return false;
+    }
+
+    void check(size_t idx) {
+        Around a = around(idx);
+        if (a.num_of_unknown == 0) return ;
+        if (a.missing == 0) {
+            for (size_t k = 0; k < a.num_of_unknown; k++) { open(a.unknown[k]); }
+            return ;
+        }
+        if (a.missing == static_cast<int>(a.num_of_unknown)) {
+            for (size_t k = 0; k < a.num_of_unknown; k++) { flag(a.unknown[k]); }
+            return ;
+        }
+        if (!(in_queue_[idx] & IN_PAIR_QUEUE)) {
+            in_queue_[idx] |= IN_PAIR_QUEUE;
+            pair_queue_.push_back(idx);
+        }
+    }
+    void check_pairs(size_t idx) {
+        Around a = around(idx);
+        if (a.num_of_unknown == 0) return ;
+        int row = idx / width_, col = idx % width_;
+        for (int cur_r = row - 2; cur_r <= row + 2; cur_r++) {
+            for (int cur_c = col - 2; cur_c <= col + 2; cur_c++) {
+                if (!is_valid(cur_r, cur_c)) { continue; }
+                size_t other = cur_r * width_ + cur_c;
+                if (other == idx || !is_number(other)) { continue; }
+                Around b = around(other);
+                if (b.num_of_unknown == 0) { continue; }
+                if (apply_pair(a, b) || apply_pair(b, a)) return ;
+            }
+        }
+    }
+    // b needs b.missing - a.missing mines outside a, if that is every tile
+    // only b sees, they are mines and the ones only a sees are safe
+    bool apply_pair(const Around& a, const Around& b) {
+        std::array<uint32_t, 8> only_a, only_b;
+        size_t num_only_a = 0, num_only_b = 0;
+        for (size_t k = 0; k < a.num_of_unknown; k++) {
+            if (!contains(b, a.unknown[k])) { only_a[num_only_a++] = a.unknown[k]; }
+        }
+        for (size_t k = 0; k < b.num_of_unknown; k++) {
+            if (!contains(a, b.unknown[k])) { only_b[num_only_b++] = b.unknown[k]; }
+        }
+        if (num_only_a + num_only_b == 0) return false;
+        if (b.missing - a.missing != static_cast<int>(num_only_b)) return false;
+        for (size_t k = 0; k < num_only_b; k++) { flag(only_b[k]); }
+        for (size_t k = 0; k < num_only_a; k++) { open(only_a[k]); }
+        return true;
+    }
+
+    bool is_number(size_t idx) const {
+        return state_[idx] == SAFE && cell_num(cells_[idx]) != 0;
+    }
+    // a change only matters to the numbers around it, a pair rule is
+    // found again from whichever of the two numbers is rechecked
+    void touch(size_t idx) {
+        int row = idx / width_, col = idx % width_;
+        for (int cur_r = row - 1; cur_r <= row + 1; cur_r++) {
+            for (int cur_c = col - 1; cur_c <= col + 1; cur_c++) {
+                if (!is_valid(cur_r, cur_c)) { continue; }
+                size_t cur = cur_r * width_ + cur_c;
+                if (is_number(cur) && !(in_queue_[cur] & IN_QUEUE)) {
+                    in_queue_[cur] |= IN_QUEUE;
+                    queue_.push_back(cur);
+                }
+            }
+        }
+    }
+    void flag(size_t idx) {
+        if (state_[idx] != UNKNOWN) return ;
+        assert(cell_is_mine(cells_[idx]));
+        state_[idx] = FLAGGED;
+        num_of_unknown_--;
+        num_of_flagged_++;
+        touch(idx);
+    }
+    // flood fill through the zeros, like Board::reveal()
+    void open(size_t idx) {
+        // an earlier flood fill of the same rule may have got here
+        if (state_[idx] != UNKNOWN) return ;
+        assert(!cell_is_mine(cells_[idx]));
+        state_[idx] = SAFE;
+        num_of_unknown_--;
+        stack_.clear();
+        stack_.push_back(idx);
+        while (!stack_.empty()) {
+            idx = stack_.back();
+            stack_.pop_back();
+            touch(idx);
+            if (cell_num(cells_[idx]) != 0) { continue; }
+            int row = idx / width_, col = idx % width_;
+            for (auto&& [inc_r, inc_c] : dirs) {
+                int cur_r = row + inc_r, cur_c = col + inc_c;
+                if (!is_valid(cur_r, cur_c)) { continue; }
+                size_t cur = cur_r * width_ + cur_c;
+                if (state_[cur] != UNKNOWN) { continue; }
+                state_[cur] = SAFE;
+                num_of_unknown_--;
+                stack_.push_back(cur);
+            }
+        }
+    }
+
+    const cell_t* cells_ = nullptr;
+    size_t height_ = 0;
+    size_t width_ = 0;
+    std::vector<uint8_t> state_;
+    std::vector<uint8_t> in_queue_;
+    std::vector<uint32_t> queue_;
+    std::vector<uint32_t> pair_queue_;
+    std::vector<uint32_t> stack_;
+    size_t num_of_unknown_ = 0;
+    size_t num_of_flagged_ = 0;
+};  // endof class NoGuessSolver
+
+// Builds the candidate of a seed and runs the solver on it.
+// One per thread, it keeps its buffers between candidates.
+class NoGuessGenerator {
+public:
+    NoGuessGenerator(size_t height, size_t width, size_t num_of_mine)
+        : height_(height), width_(width), num_of_mine_(num_of_mine),
+          cells_(height * width), scratch_(neighbor_scratch_size(height, width)) {}
+
+    bool is_solvable(uint64_t seed) {
+        std::fill(cells_.begin(), cells_.end(), 0);
+        Xoshiro256 rng(seed);
+        size_t start = place_mines_no_guess(rng, cells_.data(), height_, width_, num_of_mine_);
+        count_neighbor_mines(cells_.data(), cells_.data(), height_, width_, scratch_.data());
+        return solver_.solve(cells_.data(), height_, width_, start);
+    }
+    // tries seeds from the splitmix stream until one is solvable
+    uint64_t search(uint64_t& seed_state, size_t max_attempts=NO_GUESS_MAX_ATTEMPTS) {
+        uint64_t seed = splitmix64(seed_state);
+        for (size_t k = 1; k < max_attempts && !is_solvable(seed); k++) {
+            seed = splitmix64(seed_state);
+        }
+        return seed;
+    }
+
+private:
+    size_t height_;
+    size_t width_;
+    size_t num_of_mine_;
+    std::vector<cell_t> cells_;
+    std::vector<uint8_t> scratch_;
+    NoGuessSolver solver_;
+};  // endof class NoGuessGenerator
+
+// Worker threads keep a bounded queue of verified seeds for one board
+// shape, so a new game only replays a seed instead of searching for one.
+class NoGuessPool {
+public:
+    NoGuessPool(size_t height, size_t width, size_t num_of_mine,
+                size_t capacity=NO_GUESS_POOL_CAPACITY,
+                size_t num_of_worker=NO_GUESS_POOL_WORKERS)
+        : height_(height), width_(width), num_of_mine_(num_of_mine),
+          capacity_(capacity) {
+        if (num_of_worker == 0) {
+            num_of_worker = std::max(1U, std::thread::hardware_concurrency() / 2);
+        }
+        for (size_t k = 0; k < num_of_worker; k++) {
+            workers_.emplace_back(&NoGuessPool::work, this, fresh_seed());
+        }
+    }
+    ~NoGuessPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        not_full_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+    NoGuessPool(const NoGuessPool&) = delete;
+    NoGuessPool& operator=(const NoGuessPool&) = delete;
+
+    // false if no seed is ready
+    bool try_pop(uint64_t& seed) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (ready_.empty()) return false;
+        seed = ready_.front();
+        ready_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+private:
+    void work(uint64_t seed_state) {
+        NoGuessGenerator generator(height_, width_, num_of_mine_);
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                not_full_.wait(lock, [this] { return stop_ || ready_.size() < capacity_; });
+                if (stop_) return ;
+            }
+            uint64_t seed = splitmix64(seed_state);
+            if (!generator.is_solvable(seed)) { continue; }
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (ready_.size() < capacity_) {
+                ready_.push_back(seed);
+            }
+        }
+    }
+
+    size_t height_;
+    size_t width_;
+    size_t num_of_mine_;
+    size_t capacity_;
+    std::mutex mtx_;
+    std::condition_variable not_full_;
+    std::deque<uint64_t> ready_;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+};  // endof class NoGuessPool
+
+// one pool per board shape, started on first use
+inline NoGuessPool& no_guess_pool(size_t height, size_t width, size_t num_of_mine) {
+    static std::mutex mtx;
+    static std::map<std::tuple<size_t, size_t, size_t>, std::unique_ptr<NoGuessPool>> pools;
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& pool = pools[{height, width, num_of_mine}];
+    if (!pool) {
+        pool = std::make_unique<NoGuessPool>(height, width, num_of_mine);
+    }
+    return *pool;
+}
+
+// a verified seed from the pool, or searched right here if none is ready
+inline uint64_t no_guess_seed(size_t height, size_t width, size_t num_of_mine) {
+    uint64_t seed = 0;
+    if (no_guess_pool(height, width, num_of_mine).try_pop(seed)) {
+        return seed;
+    }
+    static uint64_t seed_state = fresh_seed();
+    NoGuessGenerator generator(height, width, num_of_mine);
+    return generator.search(seed_state);
+}
+
+}  // endof namespace mfwu
+
+#endif  // __NOGUESS_HPP__
@@ -2,13 +2,16 @@
 #define __PLAYER_HPP__
 
 #include "Board.hpp"
+#include "Solver.hpp"
+#include "HintEngine.hpp"
 
 namespace mfwu {
 
+template <typename Board_type=Board_base>
 class Player {
 public:
     Player() : board_(nullptr) {}
-    Player(std::shared_ptr<Board_base> board) : board_(board) {}
+    Player(std::shared_ptr<Board_type> board) : board_(board) {}
 
     virtual Command play() = 0;
     virtual void place(const Command& cmd) {
@@ -17,19 +20,43 @@ public:
 
     virtual void reset() {}
 
+    // the moves behind the last CommandType::BATCH play() returned
+    const std::vector<Command>& get_last_batch() const {
+        return batch_;
+    }
+
 protected:
     // Position last_pos_;  // place之后直接更新也不错，就不需要下一回合查看上一回合的反馈了
     // 有一说一这个挺麻烦的，因为这一轮
-    std::shared_ptr<Board_base> board_;
+    std::shared_ptr<Board_type> board_;
+    std::vector<Command> batch_;
 };  // endof class Player
 
 
-class HumanPlayer : public Player {
+template <typename Board_type=Board_base>
+class HumanPlayer : public Player<Board_type> {
 public:
-    HumanPlayer() : Player() {}
-    HumanPlayer(std::shared_ptr<Board_base> board) : Player(board) {}
+    HumanPlayer() : Player<Board_type>() {}
+    HumanPlayer(std::shared_ptr<Board_type> board) : Player<Board_type>(board) {
+        HumanPlayer::reset();
+    }
+
+    void reset() override {
+        size_t height = this->board_->height();
+        size_t width  = this->board_->width();
+        if (height * width > HINT_MAX_TILES) return ;
+        if (!hint_engine_) { hint_engine_ = std::make_unique<HintEngine>(); }
+        status_.resize(height * width);
+        for (int i = 0; i < height; i++) {
+            for (int j = 0; j < width; j++) {
+                status_[i * width + j] = tile_status(this->board_->get_tile(i, j));
+            }
+        }
+        hint_generation_ = 0;
+    }
 
     virtual Command play() override {
+        post_position();
         Command cmd = this->board_->get_command();
         log_debug("Human player puts cmd: %s",
                   CommandTypeDescription.at(static_cast<size_t>(cmd.cmdtype)).c_str());
@@ -41,7 +68,12 @@ public:
         } break;
         case CommandType::RESTART :
         case CommandType::MENU :
-        case CommandType::QUIT : {
+        case CommandType::QUIT :
+        case CommandType::UNDO :
+        case CommandType::REDO : {
+        } break;
+        case CommandType::HINT : {
+            show_hint();
         } break;
         case CommandType::XQ4MS : {
             log_info(                 "XQ41-MS cheater begins...");
@@ -56,18 +88,108 @@ public:
     }
 
     void place(const Command& cmd) {
-        return Player::place(cmd);
+        return Player<Board_type>::place(cmd);
+    }
+
+private:
+    // the position in front of the player goes to the hint engine while
+    // they think; the tiles of the last move, undo or redo are re-read,
+    // and an unchanged board keeps its generation
+    void post_position() {
+        if (!hint_engine_) return ;
+        size_t width = this->board_->width();
+        for (size_t idx : this->board_->get_last_update()) {
+            status_[idx] = tile_status(this->board_->get_tile(idx / width, idx % width));
+        }
+        uint64_t hash = this->board_->zobrist();
+        if (hint_generation_ != 0 && hash == hint_hash_) return ;
+        hint_hash_ = hash;
+        hint_generation_ = hint_engine_->post(status_, this->board_->height(), width,
+                                              this->board_->mines_left());
+    }
+    void show_hint() {
+        if (!hint_engine_) {
+            std::cout << HELPER_NO_HINT << "\n";
+            return ;
+        }
+        HintEngine::Hint hint;
+        if (!hint_engine_->wait(hint_generation_, hint)) return ;
+        if (hint_heatmap() && hint.result == SolveResult::SOLVED) {
+            this->board_->show_heatmap(hint.heatmap);
+        }
+        if (hint.result == SolveResult::NO_FIT) {
+            std::cout << HELPER_HINT_NO_FIT << "\n";
+        } else if (hint.result == SolveResult::TIMEOUT) {
+            std::cout << HELPER_HINT_TIMEOUT << "\n";
+        } else if (hint.cmd.pos.row >= 0) {
+            std::cout << "Hint: " << command_text(hint.cmd) << ", mine probability "
+                      << std::fixed << std::setprecision(3) << hint.prob << "\n";
+            std::cout.unsetf(std::ios::fixed);
+        }
+        log_info("Hint for generation %lu: [%d, %d], mine probability %.3f",
+                 hint_generation_, hint.cmd.pos.row, hint.cmd.pos.col, hint.prob);
     }
 
+    std::unique_ptr<HintEngine> hint_engine_;  // none on boards too large
+    std::vector<uint8_t> status_;  // cell_status() of every tile
+    uint64_t hint_generation_ = 0;  // 0 before the first post
+    uint64_t hint_hash_ = 0;        // zobrist() of the posted position
 };  // endof class HumanPlayer
 
 
-class RobotPlayer : public Player {
+template <typename Board_type=Board_base>
+class RobotPlayer : public Player<Board_type> {
 public:
-    RobotPlayer() : Player() {}
-    RobotPlayer(std::shared_ptr<Board_base> board) : Player(board) {}
+    RobotPlayer() : Player<Board_type>() {}
+    RobotPlayer(std::shared_ptr<Board_type> board) : Player<Board_type>(board) {
+        RobotPlayer::reset();
+    }
+
+    // follows the board seed, so a whole robot game replays from it
+    void reset() override {
+        uint64_t seed = this->board_->get_seed();
+        rng_.seed(splitmix64(seed));
+        num_of_guess_ = 0;
+    }
 
+    // moves this game not known to be safe, see get_best_cmd()
+    size_t num_of_guess() const {
+        return num_of_guess_;
+    }
+
+    // The certain moves queued behind the first one are placed in the same
+    // call and come back as one CommandType::BATCH, see get_last_batch(),
+    // so that the board is shown and archived once for all of them.
+    // A move that changed nothing is not journaled by the board, so it is
+    // left out of the batch too, to keep undo in step with the frames.
     virtual Command play() override {
+        this->batch_.clear();
+        Command cmd = this->play_once();
+        bool changed = false;
+        while (cmd.cmdtype == CommandType::FLAG
+               || cmd.cmdtype == CommandType::REVEAL) {
+            changed = !this->board_->get_last_update().empty();
+            if (changed) { this->batch_.push_back(cmd); }
+            if (this->board_->is_end(cmd.pos.row, cmd.pos.col) != 0
+                || !this->has_certain_move()) { break; }
+            cmd = this->play_once();
+        }
+        if (this->batch_.empty()) { return cmd; }
+        // a lone move stands for itself only if it was the last one placed
+        if (this->batch_.size() == 1 && changed) { return this->batch_.front(); }
+        return Command{CommandType::BATCH, {-1, -1}};
+    }
+
+    void place(const Command& cmd) override {
+        Player<Board_type>::place(cmd);
+    }
+
+protected:
+    virtual Command get_best_cmd() = 0;
+    // whether get_best_cmd() would give a move known to be right
+    virtual bool has_certain_move() { return false; }
+
+    Command play_once() {
         Command cmd = this->get_best_cmd();
         if (cmd.cmdtype != CommandType::FLAG
             && cmd.cmdtype != CommandType::REVEAL) {
@@ -85,19 +207,21 @@ public:
         return cmd;
     }
 
-    void place(const Command& cmd) override {
-        Player::place(cmd);
+    // worker threads shared by every robot, see ThreadPool.hpp
+    WorkStealingPool& pool() const {
+        return solver_pool();
     }
 
-protected:
-    virtual Command get_best_cmd() = 0;
+    Xoshiro256 rng_;
+    size_t num_of_guess_ = 0;
 };  // endof class RobotPlayer
 
 
-class DebugRobot : public RobotPlayer {
+template <typename Board_type=Board_base>
+class DebugRobot : public RobotPlayer<Board_type> {
 public:
-    DebugRobot() : RobotPlayer() {}
-    DebugRobot(std::shared_ptr<Board_base> board) : RobotPlayer(board) {}
+    DebugRobot() : RobotPlayer<Board_type>() {}
+    DebugRobot(std::shared_ptr<Board_type> board) : RobotPlayer<Board_type>(board) {}
 private:
     Command get_best_cmd() override {
         size_t height = this->board_->height();
@@ -105,34 +229,282 @@ private:
 
         int row = -1, col = -1;
         while (is_valid(row, col) == false) {
-            row = rand() % height;
-            col = rand() % width;
+            row = this->rng_.bounded(height);
+            col = this->rng_.bounded(width);
         }
         sleep(1);
+        this->num_of_guess_++;
         return {CommandType::REVEAL, {row, col}};
     }
 
     bool is_valid(int row, int col) const {
-        if (row < 0 || row >= this->board_->height()) return false;
-        if (col < 0 || col >= this->board_->width()) return false;
-        if (this->board_->get_pos(row, col)
-            ->get_cover() == Cover::REVEALED) return false;
-        return true;
+        const BoardView view = this->board_->view();
+        if (!view.is_valid(row, col)) return false;
+        return view.is_covered(row, col);
     }
 };  // endof class DebugRobot
 
-class HumanLikeRobot : public RobotPlayer {
+// Plays by the exact frontier probabilities, see Solver.hpp:
+// every certain move first, otherwise the tile least likely a mine.
+template <typename Board_type=Board_base>
+class SolverRobot : public RobotPlayer<Board_type> {
+public:
+    SolverRobot() : RobotPlayer<Board_type>() {
+        solver_.set_pool(robot_pool() ? &this->pool() : nullptr);
+        solver_.set_budget(std::chrono::microseconds(SOLVER_MOVE_BUDGET_US));
+    }
+    SolverRobot(std::shared_ptr<Board_type> board) : RobotPlayer<Board_type>(board) {
+        solver_.set_pool(robot_pool() ? &this->pool() : nullptr);
+        solver_.set_budget(std::chrono::microseconds(SOLVER_MOVE_BUDGET_US));
+        SolverRobot::reset();
+    }
+
+    void reset() override {
+        RobotPlayer<Board_type>::reset();
+        cmd_queue_.clear();
+    }
+
+protected:
+    Command get_best_cmd() override {
+        if (has_certain_move()) {
+            Command cmd = cmd_queue_.back();
+            cmd_queue_.pop_back();
+            return cmd;
+        }
+        const BoardView view = this->board_->view();
+        SolveResult res = solver_.solve(view.data(), view.height(), view.width(),
+                                        this->board_->mines_left());
+        if (res == SolveResult::NO_FIT) {
+            log_warn("No mine layout fits the board, a flag must be wrong");
+            this->num_of_guess_++;
+            return guess_interior(true);
+        }
+        if (res == SolveResult::TIMEOUT) {
+            log_info("Solver out of time, %lu sampled components found no layout",
+                     solver_.num_of_sampled());
+            this->num_of_guess_++;
+            return guess_interior(true);
+        }
+        log_info("Solver: %lu frontier tiles in %lu components, the largest %lu",
+                 solver_.frontier().size(), solver_.num_of_component(),
+                 solver_.largest_component());
+        if (!solver_.is_exact()) {
+            log_info("Solver: %lu components sampled in %lu paths, stderr up to %.3f",
+                     solver_.num_of_sampled(), solver_.num_of_sample(), solver_.max_stderr());
+        }
+        queue_certain_moves();
+        if (!cmd_queue_.empty()) {
+            Command cmd = cmd_queue_.back();
+            cmd_queue_.pop_back();
+            return cmd;
+        }
+        this->num_of_guess_++;
+        return guess();
+    }
+    // a reveal may have opened a queued tile already
+    bool has_certain_move() override {
+        const BoardView view = this->board_->view();
+        while (!cmd_queue_.empty()) {
+            const Command& cmd = cmd_queue_.back();
+            if (view.is_rest(cmd.pos.row, cmd.pos.col)) { return true; }
+            cmd_queue_.pop_back();
+        }
+        return false;
+    }
+
+    // flags are queued first, so that the reveals come out first
+    void queue_certain_moves() {
+        const BoardView view = this->board_->view();
+        size_t width = view.width();
+        for (CommandType cmd_type : {CommandType::FLAG, CommandType::REVEAL}) {
+            double target = cmd_type == CommandType::FLAG ? 1.0 : 0.0;
+            for (size_t idx : solver_.frontier()) {
+                if (std::abs(solver_.prob(idx) - target) < SOLVER_EPS) {
+                    cmd_queue_.push_back({cmd_type, {static_cast<int>(idx / width), 
+                                                     static_cast<int>(idx % width)}});
+                }
+            }
+            if (solver_.num_of_interior() > 0
+                && std::abs(solver_.interior_prob() - target) < SOLVER_EPS) {
+                for (size_t idx = 0; idx < view.size(); idx++) {
+                    if (view[idx] == 0xA && !solver_.on_frontier(idx)) {
+                        cmd_queue_.push_back({cmd_type, {static_cast<int>(idx / width), 
+                                                         static_cast<int>(idx % width)}});
+                    }
+                }
+            }
+        }
+    }
+    // the safest tile, off the frontier on a tie
+    Command guess() {
+        size_t width = this->board_->width();
+        size_t best = width * this->board_->height();
+        double best_p = 2.0;
+        for (size_t idx : solver_.frontier()) {
+            if (solver_.prob(idx) < best_p) {
+                best_p = solver_.prob(idx);
+                best = idx;
+            }
+        }
+        if (solver_.num_of_interior() > 0 && solver_.interior_prob() <= best_p) {
+            return guess_interior(false);
+        }
+        log_info("Robot guesses [%lu, %lu], mine probability %.3f",
+                 best / width, best % width, best_p);
+        return {CommandType::REVEAL, {static_cast<int>(best / width), 
+                                      static_cast<int>(best % width)}};
+    }
+    // a random unknown tile, any unknown one if any_tile is set
+    Command guess_interior(bool any_tile) {
+        const BoardView view = this->board_->view();
+        size_t width = view.width();
+        candidates_.clear();
+        for (size_t idx = 0; idx < view.size(); idx++) {
+            if (view[idx] != 0xA) { continue; }
+            if (any_tile || !solver_.on_frontier(idx)) { candidates_.push_back(idx); }
+        }
+        assert(!candidates_.empty());
+        size_t idx = candidates_[this->rng_.bounded(candidates_.size())];
+        log_info("Robot guesses [%lu, %lu] off the frontier, mine probability %.3f",
+                 idx / width, idx % width, any_tile ? -1.0 : solver_.interior_prob());
+        return {CommandType::REVEAL, {static_cast<int>(idx / width), 
+                                      static_cast<int>(idx % width)}};
+    }
+
+    FrontierSolver solver_;
+    std::vector<Command> cmd_queue_;
+    std::vector<size_t> candidates_;
+};  // endof class SolverRobot
+
+// Pairs of tiles at most 2 apart each way, the pairs HumanLikeRobot
+// compares. PositionPair puts the larger tile first, so a pair is the
+// smaller tile and one of 13 offsets to the other: a bit each, keyed by
+// tile * NUM_OF_OFFSET + offset, makes insert / erase / lookup O(1)
+// with no allocation once reset() sized it for the board.
+class PairSet {
+public:
+    static constexpr size_t NUM_OF_OFFSET = 13;  // (0, 0 ~ 2), (1 ~ 2, -2 ~ 2)
+
+    void reset(size_t height, size_t width) {
+        width_ = width;
+        bits_.assign((height * width * NUM_OF_OFFSET + 63) / 64, 0);
+        size_ = 0;
+    }
+
+    size_t key(const PositionPair& pp) const {
+        int inc_r = pp.p1.row - pp.p2.row, inc_c = pp.p1.col - pp.p2.col;
+        assert(0 <= inc_r && inc_r <= 2 && -2 <= inc_c && inc_c <= 2);
+        size_t offset = inc_r == 0 ? inc_c : 3 + (inc_r - 1) * 5 + (inc_c + 2);
+        return (pp.p2.row * width_ + pp.p2.col) * NUM_OF_OFFSET + offset;
+    }
+    PositionPair pair(size_t key) const {
+        size_t idx = key / NUM_OF_OFFSET, offset = key % NUM_OF_OFFSET;
+        int row = idx / width_, col = idx % width_;
+        int inc_r = offset < 3 ? 0 : 1 + (offset - 3) / 5;
+        int inc_c = offset < 3 ? offset : static_cast<int>((offset - 3) % 5) - 2;
+        return {{row + inc_r, col + inc_c}, {row, col}};
+    }
+
+    bool contains(size_t key) const {
+        return bits_[key / 64] >> (key % 64) & 1;
+    }
+    // false if it was there already
+    bool insert(size_t key) {
+        uint64_t bit = 1ULL << (key % 64);
+        if (bits_[key / 64] & bit) return false;
+        bits_[key / 64] |= bit;
+        size_++;
+        return true;
+    }
+    void erase(size_t key) {
+        uint64_t bit = 1ULL << (key % 64);
+        if (!(bits_[key / 64] & bit)) return ;
+        bits_[key / 64] &= ~bit;
+        size_--;
+    }
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+private:
+    size_t width_ = 0;
+    std::vector<uint64_t> bits_;
+    size_t size_ = 0;
+};  // endof class PairSet
+
+// FIFO of PairSet keys in a ring that doubles when full,
+// so it stops allocating once it has seen its largest backlog
+class PairQueue {
 public:
-    HumanLikeRobot() : RobotPlayer() {}
-    HumanLikeRobot(std::shared_ptr<Board_base> board) : RobotPlayer(board) {}
+    void clear() {
+        head_ = size_ = 0;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    size_t front() const {
+        return ring_[head_];
+    }
+    void push(size_t key) {
+        if (size_ == ring_.size()) { grow(); }
+        ring_[(head_ + size_) & (ring_.size() - 1)] = key;
+        size_++;
+    }
+    void pop() {
+        head_ = (head_ + 1) & (ring_.size() - 1);
+        size_--;
+    }
+
 private:
+    void grow() {
+        std::vector<size_t> ring(std::max<size_t>(64, 2 * ring_.size()));
+        for (size_t k = 0; k < size_; k++) {
+            ring[k] = ring_[(head_ + k) & (ring_.size() - 1)];
+        }
+        ring_.swap(ring);
+        head_ = 0;
+    }
+
+    std::vector<size_t> ring_;  // a power of 2 long
+    size_t head_ = 0;
+    size_t size_ = 0;
+};  // endof class PairQueue
+
+template <typename Board_type=Board_base>
+class HumanLikeRobot : public RobotPlayer<Board_type> {
+public:
+    HumanLikeRobot() : RobotPlayer<Board_type>() {}
+    HumanLikeRobot(std::shared_ptr<Board_type> board) : RobotPlayer<Board_type>(board) {
+        HumanLikeRobot::reset();
+    }
+
     void reset() override {
+        RobotPlayer<Board_type>::reset();
         is_in_opening_ = true;
+        linear_dirty_ = true;
         cmd_queue_.clear();
-        std::queue<PositionPair> empty_queue{};
-        std::swap(check_queue_, empty_queue);
-        queue_menbers_.clear();
-        all_possible_pairs_.clear();
+        check_queue_.clear();
+        queue_menbers_.reset(this->board_->height(), this->board_->width());
+        all_possible_pairs_.reset(this->board_->height(), this->board_->width());
+        if (game_stats_.moves > 0) {
+            log_info("Pairs this game: %lu checked over %lu moves",
+                     game_stats_.checked, game_stats_.moves);
+        }
+        game_stats_ = {};
+    }
+    // marks the pairs around the tiles this move touched
+    // (a whole zero region at most), and the constraints as changed
+    void place(const Command& cmd) override {
+        RobotPlayer<Board_type>::place(cmd);
+        linear_dirty_ |= !this->board_->get_last_update().empty();
+        size_t width = this->board_->width();
+        for (size_t idx : this->board_->get_last_update()) {
+            update_deduction({static_cast<int>(idx / width), 
+                              static_cast<int>(idx % width)});
+        }
     }
 
     Command play() override {
@@ -144,6 +516,7 @@ private:
             }
             log_info("Robot randomly reveals:");
             cmd = this->randomly_reveal();
+            this->num_of_guess_++;
             if (cmd.cmdtype != CommandType::REVEAL) {
                 log_info("Invalid cmd type returned from randomly_reveal()");
                 return Command{CommandType::INVALID, {}};
@@ -157,192 +530,139 @@ private:
                     cmd.pos.row, cmd.pos.col);
             this->place(cmd);
         } else {
-            cmd = RobotPlayer::play();
-        }
-        if (cmd.cmdtype == CommandType::REVEAL 
-            and this->board_->get_pos(cmd.pos.row, cmd.pos.col)->get_cover() == Cover::REVEALED
-            and this->board_->get_pos(cmd.pos.row, cmd.pos.col)->get_num() == 0) {
-            std::unordered_set<Position, PositionHash, PositionEqual> found;
-            recursive_update_deduction(cmd.pos, found);
-        } else {
-            update_deduction(cmd.pos);
+            move_stats_ = {};
+            cmd = RobotPlayer<Board_type>::play();
+            if (move_stats_.checked > 0) {
+                log_info("Pairs: %lu checked of %lu live ones",
+                         move_stats_.checked, all_possible_pairs_.size());
+            }
+            game_stats_.moves += this->batch_.size();
+            game_stats_.checked += move_stats_.checked;
         }
         return cmd;
     }
 
-    void recursive_update_deduction(const Position& pos, 
-        std::unordered_set<Position, PositionHash, PositionEqual>& found) {
-        assert(this->board_->get_pos(pos.row, pos.col)->get_cover() == Cover::REVEALED);
-        update_deduction(pos);
-        if (this->board_->get_pos(pos.row, pos.col)->get_num() == 0) {
-            for (auto&& [inc_r, inc_c] : dirs) {
-                int cur_r = pos.row + inc_r,
-                    cur_c = pos.col + inc_c;
-                if (!this->board_->is_valid(cur_r, cur_c)) { continue; }
-                assert(this->board_->get_pos(cur_r, cur_c)->get_cover() == Cover::REVEALED);
-                Position p = {cur_r, cur_c};
-                if (!found.count(p)) {
-                    found.insert(p);
-                    recursive_update_deduction(p, found);
-                }
-            }
-        }
-    }
-    
+private:
     bool is_good_opening() const {
-        size_t height = this->board_->height();
-        size_t width  = this->board_->width();
+        const BoardView view = this->board_->view();
         int revealed_tile_num = 0;
-        for (int i = 0; i < height; i++) {
-            for (int j = 0; j < width; j++) {
-                if (this->board_->get_pos(i, j)->get_cover() == Cover::REVEALED) {
-                    revealed_tile_num++;
-                }
+        for (size_t idx = 0; idx < view.size(); idx++) {
+            if (view[idx] < 0xA) {
+                revealed_tile_num++;
             }
         }
-        return revealed_tile_num > 30 or (float)revealed_tile_num / (height * width) > 0.1F; 
+        return revealed_tile_num > 30 or (float)revealed_tile_num / view.size() > 0.1F; 
     }
-    Command randomly_reveal() const {
+    Command randomly_reveal() {
+        const BoardView view = this->board_->view();
         int row = -1, col = -1;
-        while ((row < 0 || row >= this->board_->height()) 
-            or (col < 0 || col >= this->board_->width()) 
-            or (this->board_->get_pos(row, col)->get_cover() == Cover::REVEALED)
-            or (this->board_->get_pos(row, col)->get_flag() == Flag::FLAG)) {
-            row = rand() % this->board_->height();
-            col = rand() % this->board_->width();
+        while (!view.is_valid(row, col) or !view.is_rest(row, col)) {
+            row = this->rng_.bounded(view.height());
+            col = this->rng_.bounded(view.width());
         }
         // sleep(1);
         return {CommandType::REVEAL, {row, col}};
     }
     bool is_covered(const Position& pos) const {
-        return this->board_->get_pos(pos.row, pos.col)->get_cover() == Cover::COVERED;
+        return this->board_->view().is_covered(pos.row, pos.col);
     }
     void record(const PositionPair& pp) {
+        size_t key = queue_menbers_.key(pp);
+        if (queue_menbers_.contains(key)) return ;  // dirty already
         if (is_covered(pp.p1) || is_covered(pp.p2)) return ;
         if (this->board_->all_clear(pp)) return ;
-        if (!queue_menbers_.count(pp)) {
-            queue_menbers_.insert(pp);
-            check_queue_.emplace(pp);
-        }
-        if (!all_possible_pairs_.count(pp)) {
-            all_possible_pairs_.emplace(pp);
-        }
+        queue_menbers_.insert(key);
+        check_queue_.push(key);
+        all_possible_pairs_.insert(key);
     }
     void init_deduction() {
-        size_t height = this->board_->height();
-        size_t width  = this->board_->width();
-        for (int i = 0; i < height; i++) {
-            for (int j = 0; j < width; j++) {
-                if (this->board_->get_pos(i, j)->get_cover() == Cover::REVEALED) {
+        const BoardView view = this->board_->view();
+        for (int i = 0; i < view.height(); i++) {
+            for (int j = 0; j < view.width(); j++) {
+                if (!view.is_covered(i, j)) {
                     record({{i, j}, {i, j}});
                     for (auto&& [inc_r, inc_c] : ldirs) {  //
                         int cur_r = i + inc_r,
                             cur_c = j + inc_c;
-                        if (!this->board_->is_valid(cur_r, cur_c)) { continue; }
+                        if (!view.is_valid(cur_r, cur_c)) { continue; }
                         record({{i, j}, {cur_r, cur_c}});
                     }
                 }
             }
         }
     }
+    // A pair reads its two tiles and their neighbors, so a changed tile
+    // dirties every pair with a tile next to it (or itself): those and
+    // only those go back to check_queue_.
     void update_deduction(const Position& pos) {
-        record({pos, pos});
+        record_around({pos.row, pos.col});
         for (auto&& [inc_r, inc_c] : dirs) {
             int cur_r = pos.row + inc_r,
                 cur_c = pos.col + inc_c;
             if (!this->board_->is_valid(cur_r, cur_c)) { continue; }
-            record({{cur_r, cur_c}, {cur_r, cur_c}});
+            record_around({cur_r, cur_c});
+        }
+    }
+    void record_around(const Position& pos) {
+        if (is_covered(pos)) return ;  // no pair of its own yet
+        record({pos, pos});
+        for (auto&& [inc_r, inc_c] : ldirs) {
+            int cur_r = pos.row + inc_r,
+                cur_c = pos.col + inc_c;
+            if (!this->board_->is_valid(cur_r, cur_c)) { continue; }
             record({pos, {cur_r, cur_c}});
-            for (auto&& [inc_r1, inc_c1] : dirs) {
-                int cur_r1 = cur_r + inc_r1,
-                    cur_c1 = cur_c + inc_c1;
-                if (!this->board_->is_valid(cur_r1, cur_c1)) { continue; }
-                record({{cur_r, cur_c}, {cur_r1, cur_c1}});
-                record({pos, {cur_r1, cur_c1}});
-            }
         }
     }
 
     Command get_best_cmd() override {
         Command cmd = {CommandType::INVALID, {}};
-        if (!cmd_queue_.empty()) {
+        if (has_certain_move()) {
             cmd = std::move(cmd_queue_.back());
             cmd_queue_.pop_back();
-        } else {
-            size_t height = this->board_->height();
-            size_t width  = this->board_->width();
-            if (!check_queue_.empty()) {
-                // 查询是否有能确定的，有则直接 return，如果没有确定的，挑可能性最高的 return 
-                float max_p = 0.0F;
-                bool opt_flag = false;
-                // Command cmp_tmp = {CommandType::INVALID, {}};
-                while (!check_queue_.empty()) {
-                    PositionPair pp = check_queue_.front();
-                    // check_queue_.pop();  // 不要在这里 pop
-                    if (this->board_->all_clear(pp)) {
-                        all_possible_pairs_.erase(pp);
-                        queue_menbers_.erase(pp);
-                        check_queue_.pop();
-                    } else {
-                        std::pair<float, Command> res = calc_prob(pp);
-                        if (res.first + eps >= 1.0F) {
-                            cmd = res.second;
-                            opt_flag = true;
-                            // 有确定的先不 pop，再查一遍
-                            // 有了cmd_queue以后好像没有必要了
-                            // 但又好像还有点必要，因为他们动了以后pp包受影响的，后面又会加回来，没必要pop了
-                            break;
-                        } 
-                        if (max_p < res.first) {
-                            max_p = res.first;
-                            cmd = res.second;
-                        }
-                        queue_menbers_.erase(pp);
-                        check_queue_.pop();
-                    }
-                }
-                if (!is_once_ && !opt_flag) {
-                    if (!all_possible_pairs_.empty()) {
-                        // 遍历所有可能的 PositionPair，插入到待检查序列中
-                        // 还有一种可能，cmd点开的是 0，应当检查这一片连通域的结果  // play 里面检查过了
-                        // 有没有可能， all_possible_pairs 里面有确定解，但不在check_queue里面，导致忽略了
-                        // 搬过来试试（暂时没有发现，先注释掉，后面发现了再说）
-                        // 不过我发现，all_possible_pairs_好像没有单独出现的地方，也就是它好像没有用 5.6
-                        // 还是有用的，可能 check_queue里面有些内容一开始是不可解的，但后面时机成熟了已经被pop掉了
-                        // 另外，用在调试时也很不错，方便查看有什么pair可以考虑
-                        for (auto&& pp : all_possible_pairs_) {
-                            check_queue_.emplace(pp);
-                        }
-                        queue_menbers_ = all_possible_pairs_;
-                        cmd = get_best_cmd_once();
-                    }
-                    if (check_queue_.empty()) {
-                        log_info("Uncertain next move, asking for human intervention");
-                        // debug
-                        // for (auto&& pp : all_possible_pairs_) {
-                        //     std::cout << "[" << pp.p1.row << ", " << pp.p1.col << "]"
-                        //               << " [" << pp.p2.row << ", " << pp.p2.col << "]" << "\n";
-                        // }
-                        cmd = this->board_->get_command();
-                        log_info("Command type: %s, pos: [%d, %d]", 
-                            CommandTypeDescription.at(static_cast<size_t>(cmd.cmdtype)).c_str(), 
-                            cmd.pos.row, cmd.pos.col);
-                    }
-                }
-                assert(cmd.cmdtype != CommandType::INVALID);
-            } else if (!is_once_ && !all_possible_pairs_.empty()) {
-                // 可能 all_possible_pairs 里面有确定解，但不在check_queue里面，导致忽略了
-                for (auto&& pp : all_possible_pairs_) {
-                    check_queue_.emplace(pp);
+        } else if (!all_possible_pairs_.empty() && linear_dirty_ && linear_deduce()) {
+            // the whole frontier at once, ahead of the pairs
+            cmd = std::move(cmd_queue_.back());
+            cmd_queue_.pop_back();
+        } else if (!check_queue_.empty()) {
+            // 查询是否有能确定的，有则直接 return
+            // 只查被上一步弄脏的 pair，其余的结果不会变
+            bool opt_flag = false;
+            while (!check_queue_.empty()) {
+                size_t key = check_queue_.front();
+                PositionPair pp = queue_menbers_.pair(key);
+                // check_queue_.pop();  // 不要在这里 pop
+                if (this->board_->all_clear(pp)) {
+                    all_possible_pairs_.erase(key);
+                    queue_menbers_.erase(key);
+                    check_queue_.pop();
+                } else {
+                    move_stats_.checked++;
+                    std::pair<float, Command> res = calc_prob(pp);
+                    if (res.first + eps >= 1.0F) {
+                        cmd = res.second;
+                        opt_flag = true;
+                        // 有确定的先不 pop，再查一遍
+                        // 因为他们动了以后pp包受影响的，后面又会加回来，没必要pop了
+                        break;
+                    } 
+                    queue_menbers_.erase(key);
+                    check_queue_.pop();
                 }
-                queue_menbers_ = all_possible_pairs_;
-                cmd = get_best_cmd_once();
-            } else {
-                // 说明刚开始分析，此时应该有没记录的 pair，不然不会调用 get_best_cmd
-                assert(is_good_opening());
-                init_deduction();
-                cmd = get_best_cmd();
             }
+            if (!opt_flag) {
+                // every pair a move could have changed was checked,
+                // the rest gave nothing before and still cannot
+                cmd = ask_human();
+            }
+            assert(cmd.cmdtype != CommandType::INVALID);
+        } else if (!all_possible_pairs_.empty()) {
+            // nothing changed since the last check
+            cmd = ask_human();
+        } else {
+            // 说明刚开始分析，此时应该有没记录的 pair，不然不会调用 get_best_cmd
+            assert(is_good_opening());
+            init_deduction();
+            cmd = get_best_cmd();
         }
         
         // 在返回 cmd 之前，先把涉及的周围位置都纳入 check_queue_
@@ -351,83 +671,118 @@ private:
         return cmd;
     }
 
-    // 新概念 goto
-    Command get_best_cmd_once() {
-        is_once_ = true;
-        Command cmd = get_best_cmd();
-        is_once_ = false;
+    // a reveal may have opened a queued tile already
+    bool has_certain_move() override {
+        while (!cmd_queue_.empty()
+               && !is_rest(cmd_queue_.back().pos.row, cmd_queue_.back().pos.col)) {
+            cmd_queue_.pop_back();
+        }
+        return !cmd_queue_.empty();
+    }
+
+    Command ask_human() {
+        log_info("Uncertain next move, asking for human intervention");
+        this->num_of_guess_++;
+        // debug
+        // for (size_t key = 0; key < height * width * PairSet::NUM_OF_OFFSET; key++) {
+        //     if (!all_possible_pairs_.contains(key)) continue;
+        //     PositionPair pp = all_possible_pairs_.pair(key);
+        //     std::cout << "[" << pp.p1.row << ", " << pp.p1.col << "]"
+        //               << " [" << pp.p2.row << ", " << pp.p2.col << "]" << "\n";
+        // }
+        Command cmd = this->board_->get_command();
+        log_info("Command type: %s, pos: [%d, %d]", 
+            CommandTypeDescription.at(static_cast<size_t>(cmd.cmdtype)).c_str(), 
+            cmd.pos.row, cmd.pos.col);
         return cmd;
     }
 
+    // queues what elimination over all constraints proves, flags first
+    // so that the reveals come out first; the same board proves the
+    // same, so it runs again only once a move changed a tile
+    bool linear_deduce() {
+        linear_dirty_ = false;
+        const BoardView view = this->board_->view();
+        size_t width = view.width();
+        if (!linear_.deduce(view.data(), view.height(), width)) return false;
+        log_info("Linear deduction: %lu safe, %lu mines over %lu frontier tiles",
+                 linear_.safe().size(), linear_.mines().size(), linear_.frontier().size());
+        for (size_t idx : linear_.mines()) {
+            cmd_queue_.push_back({CommandType::FLAG, {static_cast<int>(idx / width), 
+                                                      static_cast<int>(idx % width)}});
+        }
+        for (size_t idx : linear_.safe()) {
+            cmd_queue_.push_back({CommandType::REVEAL, {static_cast<int>(idx / width), 
+                                                        static_cast<int>(idx % width)}});
+        }
+        return true;
+    }
+
     // NOTE: not equal to DebugRobot::is_valid
     bool is_valid(int row, int col) const {
-        if (!this->board_->is_valid(row, col)) return false;
-        // if (row < 0 || row >= this->board_->height()) return false;
-        // if (col < 0 || col >= this->board_->width()) return false;
-        if (this->board_->get_pos(row, col)
-            ->get_cover() == Cover::COVERED) return false;
-        return true;
+        const BoardView view = this->board_->view();
+        if (!view.is_valid(row, col)) return false;
+        return !view.is_covered(row, col);
     }
     bool is_rest(int row, int col) const {
-        if (!this->board_->is_valid(row, col)) return false;
-        auto cur = this->board_->get_pos(row, col);
-        return cur->get_cover() == Cover::COVERED
-            && cur->get_flag() == Flag::NO_FLAG;
+        const BoardView view = this->board_->view();
+        return view.is_valid(row, col) && view.is_rest(row, col);
     }
 
-    void count_pq(std::shared_ptr<const Position> p, std::shared_ptr<const Position>q, 
+    void count_pq(const Position& p, const Position& q, 
                   int& p_flag_cnt, int& q_flag_cnt, int& c_flag_cnt, 
                   int& p_revealed_cnt, int& q_revealed_cnt, int& c_revealed_cnt, 
                   int& p_rest_cnt, int& q_rest_cnt, int& c_rest_cnt) const {
+        const BoardView view = this->board_->view();
         for (auto&& [inc_r, inc_c] : dirs) {
-            int cur_r = p->row + inc_r,
-                cur_c = p->col + inc_c;
-            if (!this->board_->is_valid(cur_r, cur_c)) {
-                if (q->is_near({cur_r, cur_c})) {
+            int cur_r = p.row + inc_r,
+                cur_c = p.col + inc_c;
+            if (!view.is_valid(cur_r, cur_c)) {
+                if (q.is_near({cur_r, cur_c})) {
                     c_revealed_cnt++;
                 } else {
                     p_revealed_cnt++;
                 }
                 continue;
             }
-            auto cur = this->board_->get_pos(cur_r, cur_c);
-            if (q->is_near({cur_r, cur_c})) {
-                if (cur->get_cover() == Cover::REVEALED) {
+            uint8_t cur = view.status(cur_r, cur_c);
+            if (q.is_near({cur_r, cur_c})) {
+                if (cur < 0xA) {
                     c_revealed_cnt++;
-                } else if (cur->get_flag() == Flag::FLAG) {
+                } else if (cur == 0xF) {
                     c_flag_cnt++;
                 } else {
                     c_rest_cnt++;
                 }
             } else {
-                if (cur->get_cover() == Cover::REVEALED) {
+                if (cur < 0xA) {
                     p_revealed_cnt++;
-                } else if (cur->get_flag() == Flag::FLAG) {
+                } else if (cur == 0xF) {
                     p_flag_cnt++;
                 } else {
                     p_rest_cnt++;
                 }
             }
         }
-        if (q->is_near(*p)) c_revealed_cnt--;  // 去掉q本身
+        if (q.is_near(p)) c_revealed_cnt--;  // 去掉q本身
         for (auto&& [inc_r, inc_c] : dirs) {
-            int cur_r = q->row + inc_r,
-                cur_c = q->col + inc_c;
-            if (!this->board_->is_valid(cur_r, cur_c)) {
-                if (p->is_near({cur_r, cur_c})) {
+            int cur_r = q.row + inc_r,
+                cur_c = q.col + inc_c;
+            if (!view.is_valid(cur_r, cur_c)) {
+                if (p.is_near({cur_r, cur_c})) {
                     // hello world
                 } else {
                     q_revealed_cnt++;
                 }
                 continue;
             }
-            auto cur = this->board_->get_pos(cur_r, cur_c);
-            if (p->is_near({cur_r, cur_c})) {
+            uint8_t cur = view.status(cur_r, cur_c);
+            if (p.is_near({cur_r, cur_c})) {
                 // hello world
             } else {
-                if (cur->get_cover() == Cover::REVEALED) {
+                if (cur < 0xA) {
                     q_revealed_cnt++;
-                } else if (cur->get_flag() == Flag::FLAG) {
+                } else if (cur == 0xF) {
                     q_flag_cnt++;
                 } else {
                     q_rest_cnt++;
@@ -435,58 +790,60 @@ private:
             }
         }
     }
-    void dcreveal(std::shared_ptr<const Position> p) {
-        log_infer(0, "dcreveal: [%d, %d]", p->row, p->col);
+    void dcreveal(const Position& p) {
+        log_infer(0, "dcreveal: [%d, %d]", p.row, p.col);
         for (auto&& [inc_r, inc_c] : dirs) {
-            int cur_r = p->row + inc_r,
-                cur_c = p->col + inc_c;
+            int cur_r = p.row + inc_r,
+                cur_c = p.col + inc_c;
             if (!is_rest(cur_r, cur_c)) { continue; }
             cmd_queue_.push_back({CommandType::REVEAL, {cur_r, cur_c}});
         }
     }
-    void dcflag(std::shared_ptr<const Position> p) {
-        log_infer(0, "dcflag: [%d, %d]", p->row, p->col);
+    void dcflag(const Position& p) {
+        log_infer(0, "dcflag: [%d, %d]", p.row, p.col);
         for (auto&& [inc_r, inc_c] : dirs) {
-            int cur_r = p->row + inc_r,
-                cur_c = p->col + inc_c;
+            int cur_r = p.row + inc_r,
+                cur_c = p.col + inc_c;
             if (!is_rest(cur_r, cur_c)) { continue; }
             cmd_queue_.push_back({CommandType::FLAG, {cur_r, cur_c}});
         }
     }
-    void dcmp(std::shared_ptr<const Position> p, std::shared_ptr<const Position> q) {
-        log_infer(0, "dcmp: [%d, %d][%d, %d]", p->row, p->col, q->row, q->col);
+    void dcmp(const Position& p, const Position& q) {
+        log_infer(0, "dcmp: [%d, %d][%d, %d]", p.row, p.col, q.row, q.col);
         screveal(q, p);
         scflag(p, q);
     }
-    void screveal(std::shared_ptr<const Position> p, std::shared_ptr<const Position> q) {
-        log_infer(0, "screveal: [%d, %d][%d, %d]", p->row, p->col, q->row, q->col);
+    void screveal(const Position& p, const Position& q) {
+        log_infer(0, "screveal: [%d, %d][%d, %d]", p.row, p.col, q.row, q.col);
         for (auto&& [inc_r, inc_c] : dirs) {
-            int cur_r = p->row + inc_r,
-                cur_c = p->col + inc_c;
+            int cur_r = p.row + inc_r,
+                cur_c = p.col + inc_c;
             if (!is_rest(cur_r, cur_c)) { continue; }
-            if (q->is_near({cur_r, cur_c})) { continue; }
+            if (q.is_near({cur_r, cur_c})) { continue; }
             cmd_queue_.push_back({CommandType::REVEAL, {cur_r, cur_c}});
         }
     }
-    void scflag(std::shared_ptr<const Position> p, std::shared_ptr<const Position> q) {
-        log_infer(0, "scflag: [%d, %d]", p->row, p->col);
+    void scflag(const Position& p, const Position& q) {
+        log_infer(0, "scflag: [%d, %d]", p.row, p.col);
         for (auto&& [inc_r, inc_c] : dirs) {
-            int cur_r = p->row + inc_r,
-                cur_c = p->col + inc_c;
+            int cur_r = p.row + inc_r,
+                cur_c = p.col + inc_c;
             if (!is_rest(cur_r, cur_c)) { continue; }
-            if (q->is_near({cur_r, cur_c})) { continue; }
+            if (q.is_near({cur_r, cur_c})) { continue; }
             cmd_queue_.push_back({CommandType::FLAG, {cur_r, cur_c}});
         }
     }
     
     std::pair<float, Command> calc_prob(const PositionPair& pp) {
-        auto p = this->board_->get_pos(pp.p1.row, pp.p1.col);
-        auto q = this->board_->get_pos(pp.p2.row, pp.p2.col);
-        if (p->row == q->row && p->col == q->col) {
+        const BoardView view = this->board_->view();
+        const Position& p = pp.p1;
+        const Position& q = pp.p2;
+        if (p.row == q.row && p.col == q.col) {
             // CHECK: IF NEED
         }
 
-        int m = p->get_num(), n = q->get_num();
+        // both revealed, see record()
+        int m = view.status(p.row, p.col), n = view.status(q.row, q.col);
         int p_flag_cnt = 0, q_flag_cnt = 0, c_flag_cnt = 0;
         int p_revealed_cnt = 0, q_revealed_cnt = 0, c_revealed_cnt = 0;
         int p_rest_cnt = 0, q_rest_cnt = 0, c_rest_cnt = 0;
@@ -526,12 +883,21 @@ private:
         return {0.5F, randomly_reveal()};  // TODO: cannot randomly reveal, may cause longtime wait
     }
 
+    // pairs run through calc_prob()
+    struct DeductionStats {
+        size_t moves = 0;
+        size_t checked = 0;
+    };  // endof struct DeductionStats
+
     bool is_in_opening_ = true;
-    bool is_once_ = false;
+    DeductionStats move_stats_;
+    DeductionStats game_stats_;
     std::vector<Command> cmd_queue_;
-    std::queue<PositionPair> check_queue_;
-    std::unordered_set<PositionPair, PositionPairHash, PositionPairEqual> queue_menbers_;
-    std::unordered_set<PositionPair, PositionPairHash, PositionPairEqual> all_possible_pairs_;
+    LinearDeduction linear_;
+    bool linear_dirty_ = true;     // a tile changed since linear_deduce()
+    PairQueue check_queue_;        // dirty pairs, see update_deduction()
+    PairSet queue_menbers_;        // those in check_queue_
+    PairSet all_possible_pairs_;
 };  // endof class HumanLikeRobot
 
 }  // endof namespace mfwu
@@ -0,0 +1,95 @@
+#ifndef __RANDOM_HPP__
+#define __RANDOM_HPP__
+
+#include "common.hpp"
+
+namespace mfwu {
+
+// splitmix64, expands one 64-bit seed into as many words as needed
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** (Blackman & Vigna), fast and good enough for mine layouts.
+// Satisfies UniformRandomBitGenerator, so std::shuffle etc. take it too.
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    Xoshiro256(uint64_t s=0) { seed(s); }
+
+    void seed(uint64_t s) {
+        for (uint64_t& word : state_) {
+            word = splitmix64(s);
+        }
+    }
+    result_type operator()() {
+        const uint64_t ret = rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return ret;
+    }
+    // uniform in [0, bound), Lemire's multiply-shift with rejection,
+    // a division only on the rare rejection path
+    uint64_t bounded(uint64_t bound) {
+        __uint128_t m = static_cast<__uint128_t>((*this)()) * bound;
+        uint64_t low = static_cast<uint64_t>(m);
+        if (low < bound) {
+            const uint64_t threshold = -bound % bound;
+            while (low < threshold) {
+                m = static_cast<__uint128_t>((*this)()) * bound;
+                low = static_cast<uint64_t>(m);
+            }
+        }
+        return static_cast<uint64_t>(m >> 64);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+    std::array<uint64_t, 4> state_;
+};  // endof class Xoshiro256
+
+// a new seed for every game, not reproducible on purpose
+inline uint64_t fresh_seed() {
+    static uint64_t state = static_cast<uint64_t>(std::random_device{}()) << 32
+        ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return splitmix64(state);
+}
+
+// Zobrist key of tile idx showing cell_status() status. Computed rather
+// than tabled, so that every board size and every game share the keys.
+// A covered tile keys 0: an untouched board hashes to 0.
+inline uint64_t zobrist_key(size_t idx, size_t status) {
+    if (status == 0xA) return 0;
+    uint64_t state = static_cast<uint64_t>(idx) << 4 | status;
+    return splitmix64(state);
+}
+
+// Floyd's sampling of num_of_mine distinct tiles out of num_of_tile,
+// O(num_of_mine) and no hashing: is_mine / set_mine are the bitmap,
+// usually the tile storage itself, which must be cleared beforehand.
+template <typename IsMine, typename SetMine>
+void place_mines(Xoshiro256& rng, size_t num_of_tile, size_t num_of_mine,
+                 IsMine&& is_mine, SetMine&& set_mine) {
+    assert(num_of_mine <= num_of_tile);
+    for (size_t j = num_of_tile - num_of_mine; j < num_of_tile; j++) {
+        size_t t = rng.bounded(j + 1);
+        set_mine(is_mine(t) ? j : t);
+    }
+}
+
+}  // endof namespace mfwu
+
+#endif  // __RANDOM_HPP__
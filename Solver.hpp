@@ -0,0 +1,1018 @@
+#ifndef __SOLVER_HPP__
+#define __SOLVER_HPP__
+
+#include "common.hpp"
+#include "Random.hpp"
+#include "ThreadPool.hpp"
+
+namespace mfwu {
+
+// Disjoint sets over 0 ~ n-1, path halving and union by size
+class UnionFind {
+public:
+    void reset(size_t n) {
+        parent_.resize(n);
+        size_.assign(n, 1);
+        for (size_t k = 0; k < n; k++) { parent_[k] = k; }
+    }
+    size_t find(size_t x) {
+        while (parent_[x] != x) {
+            parent_[x] = parent_[parent_[x]];
+            x = parent_[x];
+        }
+        return x;
+    }
+    void unite(size_t x, size_t y) {
+        x = find(x);
+        y = find(y);
+        if (x == y) return ;
+        if (size_[x] < size_[y]) { std::swap(x, y); }
+        parent_[y] = x;
+        size_[x] += size_[y];
+    }
+
+private:
+    std::vector<size_t> parent_;
+    std::vector<size_t> size_;
+};  // endof class UnionFind
+
+// The linear constraints of a visible position.
+//
+// Every revealed number gives one: the sum over its unknown (covered,
+// unflagged) neighbors equals the number minus its flagged neighbors.
+// Flags are trusted to be mines. The unknowns in some constraint form
+// the frontier, each one a var; constraints sharing a var join into a
+// component, and components are independent of each other.
+class FrontierConstraints {
+public:
+    // status: cell_status() codes of height * width tiles, row-major
+    void build(const uint8_t* status, size_t height, size_t width) {
+        status_ = status;
+        height_ = height;
+        width_ = width;
+        build_constraints();
+        build_components();
+    }
+
+    const std::vector<size_t>& frontier() const {
+        return frontier_;
+    }
+    bool on_frontier(size_t idx) const {
+        return var_of_[idx] != NO_VAR;
+    }
+    size_t num_of_component() const {
+        return num_of_comp_;
+    }
+    size_t largest_component() const {
+        size_t ret = 0;
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            ret = std::max(ret, comp_vars_[c].size());
+        }
+        return ret;
+    }
+
+protected:
+    struct Constraint {
+        int needed;        // mines among its vars
+        int unassigned;    // its vars
+        size_t var_begin;  // its vars in cons_vars_
+        size_t var_end;
+    };  // endof struct Constraint
+
+    size_t comp_of(size_t var) {
+        return comp_of_root_[uf_.find(var)];
+    }
+
+    void build_constraints() {
+        size_t num_of_tile = height_ * width_;
+        var_of_.assign(num_of_tile, NO_VAR);
+        frontier_.clear();
+        cons_.clear();
+        cons_vars_.clear();
+        for (size_t idx = 0; idx < num_of_tile; idx++) {
+            if (status_[idx] > 8) continue;  // covered, flagged or a mine
+            int row = idx / width_, col = idx % width_;
+            int needed = status_[idx];
+            size_t begin = cons_vars_.size();
+            for (auto&& [inc_r, inc_c] : dirs) {
+                int cur_r = row + inc_r, cur_c = col + inc_c;
+                if (cur_r < 0 || cur_r >= height_ || cur_c < 0 || cur_c >= width_) { continue; }
+                size_t cur = cur_r * width_ + cur_c;
+                if (status_[cur] == 0xF) {
+                    needed--;
+                } else if (status_[cur] == 0xA) {
+                    if (var_of_[cur] == NO_VAR) {
+                        var_of_[cur] = frontier_.size();
+                        frontier_.push_back(cur);
+                    }
+                    cons_vars_.push_back(var_of_[cur]);
+                }
+            }
+            if (cons_vars_.size() == begin) continue;
+            cons_.push_back({needed, static_cast<int>(cons_vars_.size() - begin),
+                             begin, cons_vars_.size()});
+        }
+        // var -> its constraints, in CSR form
+        var_cons_begin_.assign(frontier_.size() + 1, 0);
+        for (size_t var : cons_vars_) { var_cons_begin_[var + 1]++; }
+        for (size_t v = 0; v < frontier_.size(); v++) {
+            var_cons_begin_[v + 1] += var_cons_begin_[v];
+        }
+        var_cons_.resize(cons_vars_.size());
+        fill_pos_.assign(var_cons_begin_.begin(), var_cons_begin_.end() - 1);
+        for (size_t c = 0; c < cons_.size(); c++) {
+            for (size_t k = cons_[c].var_begin; k < cons_[c].var_end; k++) {
+                var_cons_[fill_pos_[cons_vars_[k]]++] = c;
+            }
+        }
+    }
+
+    void build_components() {
+        size_t num_of_var = frontier_.size();
+        uf_.reset(num_of_var);
+        for (const Constraint& cons : cons_) {
+            for (size_t k = cons.var_begin + 1; k < cons.var_end; k++) {
+                uf_.unite(cons_vars_[cons.var_begin], cons_vars_[k]);
+            }
+        }
+        // breadth first from each root, so that neighboring vars come
+        // one after another: constraints close early in a search
+        comp_of_root_.assign(num_of_var, NO_VAR);
+        visited_.assign(num_of_var, 0);
+        size_t num_of_comp = 0;
+        for (size_t v = 0; v < num_of_var; v++) {
+            size_t root = uf_.find(v);
+            if (comp_of_root_[root] == NO_VAR) { comp_of_root_[root] = num_of_comp++; }
+        }
+        // components only grow, to keep the capacity of their vectors
+        if (comp_vars_.size() < num_of_comp) { comp_vars_.resize(num_of_comp); }
+        num_of_comp_ = num_of_comp;
+        for (size_t c = 0; c < num_of_comp_; c++) { comp_vars_[c].clear(); }
+        for (size_t v = 0; v < num_of_var; v++) {
+            if (visited_[v]) continue;
+            std::vector<size_t>& vars = comp_vars_[comp_of(v)];
+            size_t head = vars.size();
+            visited_[v] = 1;
+            vars.push_back(v);
+            while (head < vars.size()) {
+                size_t cur = vars[head++];
+                for (size_t k = var_cons_begin_[cur]; k < var_cons_begin_[cur + 1]; k++) {
+                    const Constraint& cons = cons_[var_cons_[k]];
+                    for (size_t j = cons.var_begin; j < cons.var_end; j++) {
+                        size_t next = cons_vars_[j];
+                        if (visited_[next]) continue;
+                        visited_[next] = 1;
+                        vars.push_back(next);
+                    }
+                }
+            }
+        }
+    }
+
+    static constexpr size_t NO_VAR = static_cast<size_t>(-1);
+
+    const uint8_t* status_ = nullptr;
+    size_t height_ = 0;
+    size_t width_ = 0;
+
+    std::vector<size_t> var_of_;    // tile -> var id, NO_VAR off the frontier
+    std::vector<size_t> frontier_;  // var id -> tile
+    std::vector<Constraint> cons_;
+    std::vector<size_t> cons_vars_;
+    std::vector<size_t> var_cons_begin_;  // var -> constraints, CSR
+    std::vector<size_t> var_cons_;
+    std::vector<size_t> fill_pos_;
+    UnionFind uf_;
+    std::vector<size_t> comp_of_root_;
+    std::vector<uint8_t> visited_;
+    std::vector<std::vector<size_t>> comp_vars_;  // vars of each component, BFS order
+    size_t num_of_comp_ = 0;
+};  // endof class FrontierConstraints
+
+// what FrontierSolver::solve() came to
+enum class SolveResult : size_t {
+    SOLVED = 0,   // prob() is ready, estimated for the sampled components
+    NO_FIT = 1,   // the search proved no mine layout fits (a wrong flag)
+    TIMEOUT = 2   // out of time before a sampled component found a layout
+};  // endof enum class SolveResult
+
+// Exact mine probabilities of the covered tiles of a visible position.
+//
+// Each component of FrontierConstraints is enumerated on its own by
+// backtracking, pruning as soon as a constraint can no longer be met.
+// Solutions are counted per number of mines in the component, see
+// weight().
+//
+// Every solution of a component weighs the same here; the unknowns off
+// the frontier share the mines the frontier is expected to leave. In
+// the endgame, with few unknowns left, a solution weighs instead the
+// ways the other components and the interior take the mines left, see
+// global_weights(): the mine count then decides what no number does.
+//
+// With a time budget, a component the search cannot finish in half of
+// it is sampled instead, see sample_path(), until the budget is spent;
+// its probabilities are then estimates, never 0 or 1.
+//
+// With a pool, see set_pool(), the components and the subtrees of the
+// large ones are enumerated on all threads and their counts summed up.
+//
+// Deterministic, no logging, no allocation once warm.
+class FrontierSolver : public FrontierConstraints {
+public:
+    static constexpr double UNKNOWN_PROB = -1.0;
+
+    virtual ~FrontierSolver() {}
+
+    // components, and subtrees of the large ones, are then solved
+    // on the pool, nullptr (the default) for the calling thread only
+    void set_pool(WorkStealingPool* pool) {
+        pool_ = pool;
+    }
+    // time for one solve(), 0 (the default) for no limit
+    void set_budget(std::chrono::microseconds budget) {
+        budget_ = budget;
+    }
+    // at most this many unknowns make an endgame, 0 for never
+    void set_endgame_unknowns(size_t num_of_unknown) {
+        endgame_unknowns_ = num_of_unknown;
+    }
+
+    // status: cell_status() codes of height * width tiles, row-major
+    // mines_left: mines not flagged yet, negative if the board has no total
+    // only a component searched through can prove there is no solution,
+    // one sampled without a hit just ran out of time
+    SolveResult solve(const uint8_t* status, size_t height, size_t width, int mines_left) {
+        auto start = std::chrono::steady_clock::now();
+        exact_deadline_ = start + budget_ / 2;
+        deadline_ = start + budget_;
+        expired_.store(false, std::memory_order_relaxed);
+        mines_left_ = mines_left;
+        build(status, height, width);
+        size_t num_of_slot = pool_ != nullptr && frontier_.size() >= SOLVER_PARALLEL_MIN_VARS
+                           ? pool_->num_of_worker() + 1 : 1;
+        prepare_slots(num_of_slot);
+        collect_subtrees(num_of_slot);
+        if (num_of_slot == 1) {
+            for (Subtree& sub : subtrees_) { run_subtree(sub, slots_[0]); }
+        } else {
+            TaskGroup group;
+            for (size_t k = 0; k < subtrees_.size(); k++) {
+                pool_->submit(group, [this, k] {
+                    run_subtree(subtrees_[k], slots_[pool_->current_slot()]);
+                });
+            }
+            pool_->wait(group);
+        }
+        if (!sample_unfinished(num_of_slot)) {
+            return SolveResult::TIMEOUT;
+        }
+        merge_slots(num_of_slot);
+        bool consistent = true;
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            consistent &= comps_[c].total > 0;
+        }
+        if (!consistent) {
+            return SolveResult::NO_FIT;
+        }
+        fill_prob();
+        return SolveResult::SOLVED;
+    }
+
+    // mine probability of tile idx, UNKNOWN_PROB for revealed or flagged
+    double prob(size_t idx) const {
+        return prob_[idx];
+    }
+    // the same probability for every unknown off the frontier
+    double interior_prob() const {
+        return interior_prob_;
+    }
+    size_t num_of_interior() const {
+        return num_of_interior_;
+    }
+    // whether every component of the last solve() was searched through
+    bool is_exact() const {
+        return num_of_sampled_ == 0;
+    }
+    // components sampled by the last solve(), and their paths
+    size_t num_of_sampled() const {
+        return num_of_sampled_;
+    }
+    size_t num_of_sample() const {
+        return num_of_sample_;
+    }
+    // the largest standard error of a sampled probability, 0 if exact
+    double max_stderr() const {
+        return max_stderr_;
+    }
+    // whether the last solve() weighed by the mine count, see global_weights()
+    bool is_endgame() const {
+        return is_endgame_;
+    }
+
+protected:
+    // the counts of a component, its vars in comp_vars_
+    struct Component {
+        std::vector<double> count;  // count[k]: solutions with k mines
+        std::vector<double> hits;   // hits[v * (vars + 1) + k]: of those, v is a mine
+        std::vector<double> weight; // weight[k]: relative, see global_weights()
+        double total = 0.0;
+        bool sampled = false;       // counts estimated, see sample_path()
+        double sum_w = 0.0;         // of the sampled paths
+        double sum_w2 = 0.0;
+    };  // endof struct Component
+
+    // per-thread search state: the constraints as far as assigned,
+    // the assignment by depth, and the counts of every component
+    struct Slot {
+        std::vector<int> needed;
+        std::vector<int> unassigned;
+        std::vector<uint8_t> assignment;
+        std::vector<double> acc;  // see acc_offset_ and backtrack()
+        size_t steps = 0;         // since the clock was last read
+    };  // endof struct Slot
+    // the state of sample_path(), by var and by constraint
+    struct Sample {
+        std::vector<int8_t> value;  // -1 while unassigned
+        std::vector<int> needed;
+        std::vector<int> unassigned;
+        std::vector<size_t> trail;  // vars in the order assigned
+        std::vector<size_t> queue;  // constraints to propagate
+    };  // endof struct Sample
+    // the first depth vars of comp fixed to bits, the rest to enumerate
+    struct Subtree {
+        size_t comp;
+        uint64_t bits;
+        size_t depth;
+        size_t mines;
+        bool finished;
+    };  // endof struct Subtree
+
+    // how much a solution with k mines in comp weighs, see the note above
+    virtual double weight(const Component& comp, size_t k) const {
+        return comp.weight[k];
+    }
+
+    // The subtrees below the first vars of a large component are
+    // independent too, so they make tasks of their own: with a pool,
+    // one big component keeps every thread busy.
+    void collect_subtrees(size_t num_of_slot) {
+        subtrees_.clear();
+        size_t split_depth = 2;
+        while ((size_t(1) << split_depth) < 4 * SOLVER_SPLIT_TASKS * num_of_slot) {
+            split_depth++;
+        }
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            size_t n = comp_vars_[c].size();
+            if (num_of_slot == 1 || n < SOLVER_SPLIT_MIN_VARS) {
+                subtrees_.push_back({c, 0, 0, 0, false});
+                continue;
+            }
+            split(c, slots_[0], 0, 0, 0, std::min(split_depth, n / 2));
+        }
+    }
+    void split(size_t c, Slot& slot, size_t depth, size_t mines,
+               uint64_t bits, size_t split_depth) {
+        if (depth == split_depth) {
+            subtrees_.push_back({c, bits, depth, mines, false});
+            return ;
+        }
+        size_t var = comp_vars_[c][depth];
+        for (int value = 0; value <= 1; value++) {
+            if (assign(slot, var, value)) {
+                split(c, slot, depth + 1, mines + value,
+                      bits | uint64_t(value) << depth, split_depth);
+            }
+            unassign(slot, var, value);
+        }
+    }
+    void run_subtree(Subtree& sub, Slot& slot) {
+        if (expired_.load(std::memory_order_relaxed)) return ;
+        const std::vector<size_t>& vars = comp_vars_[sub.comp];
+        for (size_t d = 0; d < sub.depth; d++) {
+            slot.assignment[d] = sub.bits >> d & 1;
+            assign(slot, vars[d], slot.assignment[d]);
+        }
+        backtrack(vars, slot, sub.depth, sub.mines, slot.acc.data() + acc_offset_[sub.comp]);
+        for (size_t d = sub.depth; d-- > 0; ) {
+            unassign(slot, vars[d], slot.assignment[d]);
+        }
+        sub.finished = !expired_.load(std::memory_order_relaxed);
+    }
+    // every few thousand nodes, the clock: past the deadline,
+    // every search unwinds and its component is sampled instead
+    bool out_of_time(Slot& slot) const {
+        if (expired_.load(std::memory_order_relaxed)) { return true; }
+        if (budget_.count() == 0 || ++slot.steps < CLOCK_STEPS) { return false; }
+        slot.steps = 0;
+        if (std::chrono::steady_clock::now() >= exact_deadline_) {
+            expired_.store(true, std::memory_order_relaxed);
+        }
+        return expired_.load(std::memory_order_relaxed);
+    }
+
+    // false once a constraint of var can no longer be met,
+    // undo with unassign() either way
+    bool assign(Slot& slot, size_t var, int value) const {
+        bool ok = true;
+        for (size_t k = var_cons_begin_[var]; k < var_cons_begin_[var + 1]; k++) {
+            size_t c = var_cons_[k];
+            slot.unassigned[c]--;
+            slot.needed[c] -= value;
+            ok &= slot.needed[c] >= 0 && slot.needed[c] <= slot.unassigned[c];
+        }
+        return ok;
+    }
+    void unassign(Slot& slot, size_t var, int value) const {
+        for (size_t k = var_cons_begin_[var]; k < var_cons_begin_[var + 1]; k++) {
+            size_t c = var_cons_[k];
+            slot.unassigned[c]++;
+            slot.needed[c] += value;
+        }
+    }
+    // acc: count[k] at acc[k], hits[v][k] at acc[(v + 1) * (n + 1) + k]
+    void backtrack(const std::vector<size_t>& vars, Slot& slot,
+                   size_t depth, size_t mines, double* acc) const {
+        size_t n = vars.size();
+        if (out_of_time(slot)) return ;
+        if (depth == n) {
+            acc[mines] += 1.0;
+            for (size_t v = 0; v < n; v++) {
+                if (slot.assignment[v]) { acc[(v + 1) * (n + 1) + mines] += 1.0; }
+            }
+            return ;
+        }
+        size_t var = vars[depth];
+        for (int value = 0; value <= 1; value++) {
+            if (assign(slot, var, value)) {
+                slot.assignment[depth] = value;
+                backtrack(vars, slot, depth + 1, mines + value, acc);
+            }
+            unassign(slot, var, value);
+        }
+        slot.assignment[depth] = 0;
+    }
+
+    void prepare_slots(size_t num_of_slot) {
+        size_t acc_size = 0, max_vars = 0;
+        acc_offset_.resize(num_of_comp_);
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            size_t n = comp_vars_[c].size();
+            acc_offset_[c] = acc_size;
+            acc_size += (n + 1) * (n + 1);
+            max_vars = std::max(max_vars, n);
+        }
+        if (comps_.size() < num_of_comp_) { comps_.resize(num_of_comp_); }
+        if (slots_.size() < num_of_slot) { slots_.resize(num_of_slot); }
+        for (size_t k = 0; k < num_of_slot; k++) {
+            Slot& slot = slots_[k];
+            slot.needed.resize(cons_.size());
+            slot.unassigned.resize(cons_.size());
+            for (size_t c = 0; c < cons_.size(); c++) {
+                slot.needed[c] = cons_[c].needed;
+                slot.unassigned[c] = cons_[c].unassigned;
+            }
+            slot.assignment.assign(max_vars, 0);
+            slot.acc.assign(acc_size, 0.0);
+        }
+    }
+    // Knuth's estimator: one random path down the search tree, taking
+    // either value where both are still possible. A path reaching the
+    // bottom weighs the product of the branching on its way, so the
+    // sum over paths, divided by their number, is an unbiased count
+    // of the solutions, and of the solutions with each var a mine.
+    // Every value is propagated through the constraints it closes,
+    // so few paths run into a dead end, see propagate().
+    void sample_path(size_t c, double* acc) {
+        const std::vector<size_t>& vars = comp_vars_[c];
+        size_t n = vars.size();
+        double w = 1.0;
+        bool reached = true;
+        for (size_t var : vars) {
+            if (sample_.value[var] >= 0) continue;
+            bool can_be_safe = try_value(var, 0);
+            bool can_be_mine = try_value(var, 1);
+            if (!can_be_safe && !can_be_mine) { reached = false; break; }
+            int value = can_be_mine;
+            if (can_be_safe && can_be_mine) {
+                value = rng_() >> 63;
+                w *= 2.0;
+            }
+            set_value(var, value);
+            propagate();
+        }
+        if (reached) {
+            size_t mines = 0;
+            for (size_t var : vars) { mines += sample_.value[var]; }
+            acc[mines] += w;
+            for (size_t v = 0; v < n; v++) {
+                if (sample_.value[vars[v]]) { acc[(v + 1) * (n + 1) + mines] += w; }
+            }
+            comps_[c].sum_w += w;
+            comps_[c].sum_w2 += w * w;
+        }
+        undo_values(0);
+        num_of_sample_++;
+    }
+    // false if a constraint of var can no longer be met
+    bool set_value(size_t var, int value) {
+        sample_.value[var] = value;
+        sample_.trail.push_back(var);
+        bool ok = true;
+        for (size_t k = var_cons_begin_[var]; k < var_cons_begin_[var + 1]; k++) {
+            size_t c = var_cons_[k];
+            sample_.unassigned[c]--;
+            sample_.needed[c] -= value;
+            ok &= sample_.needed[c] >= 0 && sample_.needed[c] <= sample_.unassigned[c];
+            sample_.queue.push_back(c);
+        }
+        return ok;
+    }
+    // a constraint with no mines left to place makes the rest safe,
+    // one with as many mines as vars makes them all mines
+    bool propagate() {
+        bool ok = true;
+        while (!sample_.queue.empty()) {
+            size_t c = sample_.queue.back();
+            sample_.queue.pop_back();
+            int needed = sample_.needed[c];
+            if (!ok || sample_.unassigned[c] == 0) continue;
+            if (needed != 0 && needed != sample_.unassigned[c]) continue;
+            for (size_t j = cons_[c].var_begin; j < cons_[c].var_end; j++) {
+                size_t var = cons_vars_[j];
+                if (sample_.value[var] < 0) { ok &= set_value(var, needed != 0); }
+            }
+        }
+        return ok;
+    }
+    void undo_values(size_t mark) {
+        while (sample_.trail.size() > mark) {
+            size_t var = sample_.trail.back();
+            sample_.trail.pop_back();
+            for (size_t k = var_cons_begin_[var]; k < var_cons_begin_[var + 1]; k++) {
+                size_t c = var_cons_[k];
+                sample_.unassigned[c]++;
+                sample_.needed[c] += sample_.value[var];
+            }
+            sample_.value[var] = -1;
+        }
+    }
+    bool try_value(size_t var, int value) {
+        size_t mark = sample_.trail.size();
+        bool ok = set_value(var, value);
+        ok = propagate() && ok;
+        undo_values(mark);
+        return ok;
+    }
+    // samples the components whose search ran out of time, round robin
+    // until the deadline, but SOLVER_MIN_SAMPLES paths each at least;
+    // returns false if one of them never reached the bottom
+    bool sample_unfinished(size_t num_of_slot) {
+        num_of_sampled_ = 0;
+        num_of_sample_ = 0;
+        sampled_.clear();
+        for (size_t c = 0; c < num_of_comp_; c++) { comps_[c].sampled = false; }
+        for (const Subtree& sub : subtrees_) {
+            comps_[sub.comp].sampled |= !sub.finished;
+        }
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            Component& comp = comps_[c];
+            if (!comp.sampled) continue;
+            size_t n = comp_vars_[c].size();
+            for (size_t k = 0; k < num_of_slot; k++) {
+                double* acc = slots_[k].acc.data() + acc_offset_[c];
+                std::fill(acc, acc + (n + 1) * (n + 1), 0.0);
+            }
+            comp.sum_w = comp.sum_w2 = 0.0;
+            sampled_.push_back(c);
+        }
+        num_of_sampled_ = sampled_.size();
+        if (sampled_.empty()) return true;
+        sample_.value.assign(frontier_.size(), -1);
+        sample_.needed.resize(cons_.size());
+        sample_.unassigned.resize(cons_.size());
+        for (size_t c = 0; c < cons_.size(); c++) {
+            sample_.needed[c] = cons_[c].needed;
+            sample_.unassigned[c] = cons_[c].unassigned;
+        }
+        double* acc = slots_[0].acc.data();
+        for (size_t round = 1; ; round++) {
+            for (size_t c : sampled_) {
+                sample_path(c, acc + acc_offset_[c]);
+            }
+            if (round < SOLVER_MIN_SAMPLES) continue;
+            if (std::chrono::steady_clock::now() < deadline_) continue;
+            bool all_reached = true;
+            for (size_t c : sampled_) { all_reached &= comps_[c].sum_w > 0.0; }
+            if (all_reached || round >= SOLVER_MIN_SAMPLES * MAX_SAMPLE_ROUNDS) {
+                return all_reached;
+            }
+        }
+    }
+
+    void merge_slots(size_t num_of_slot) {
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            Component& comp = comps_[c];
+            size_t n = comp_vars_[c].size();
+            comp.count.assign(n + 1, 0.0);
+            comp.hits.assign(n * (n + 1), 0.0);
+            for (size_t k = 0; k < num_of_slot; k++) {
+                const double* acc = slots_[k].acc.data() + acc_offset_[c];
+                for (size_t j = 0; j <= n; j++) { comp.count[j] += acc[j]; }
+                for (size_t j = 0; j < n * (n + 1); j++) { comp.hits[j] += acc[n + 1 + j]; }
+            }
+            comp.total = 0.0;
+            for (double cnt : comp.count) { comp.total += cnt; }
+        }
+    }
+
+    void fill_prob() {
+        size_t num_of_tile = height_ * width_;
+        prob_.assign(num_of_tile, UNKNOWN_PROB);
+        num_of_interior_ = 0;
+        for (size_t idx = 0; idx < num_of_tile; idx++) {
+            num_of_interior_ += status_[idx] == 0xA && var_of_[idx] == NO_VAR;
+        }
+        is_endgame_ = mines_left_ >= 0
+            && frontier_.size() + num_of_interior_ <= endgame_unknowns_
+            && global_weights();
+        if (!is_endgame_) {
+            for (size_t c = 0; c < num_of_comp_; c++) {
+                comps_[c].weight.assign(comp_vars_[c].size() + 1, 1.0);
+            }
+        }
+        max_stderr_ = 0.0;
+        double expected = 0.0;  // mines the frontier is expected to take
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            const Component& comp = comps_[c];
+            size_t n = comp_vars_[c].size();
+            double total = 0.0;
+            for (size_t k = 0; k <= n; k++) { total += comp.count[k] * weight(comp, k); }
+            for (size_t v = 0; v < n; v++) {
+                double hit = 0.0;
+                for (size_t k = 0; k <= n; k++) {
+                    hit += comp.hits[v * (n + 1) + k] * weight(comp, k);
+                }
+                double p = hit / total;
+                if (comp.sampled) {
+                    p = std::min(1.0 - INTERIOR_PROB_MARGIN, std::max(INTERIOR_PROB_MARGIN, p));
+                    // paths weigh unevenly: their effective number
+                    double num_of_path = comp.sum_w * comp.sum_w / comp.sum_w2;
+                    max_stderr_ = std::max(max_stderr_, std::sqrt(p * (1.0 - p) / num_of_path));
+                }
+                prob_[frontier_[comp_vars_[c][v]]] = p;
+                expected += p;
+            }
+        }
+        interior_prob_ = 0.0;
+        if (num_of_interior_ > 0) {
+            interior_prob_ = is_endgame_ ? endgame_interior_prob_
+                                         : estimate_interior_prob(expected);
+        }
+        for (size_t idx = 0; idx < num_of_tile; idx++) {
+            if (status_[idx] == 0xA && var_of_[idx] == NO_VAR) { prob_[idx] = interior_prob_; }
+        }
+    }
+
+    // The off-frontier tiles share what the frontier leaves on average.
+    // That is only an estimate, so 0 and 1 are kept for when the mine
+    // count proves them: the frontier takes all the mines left in every
+    // solution, or leaves one for each interior tile in every solution.
+    double estimate_interior_prob(double expected) const {
+        if (mines_left_ < 0) { return MINE_POS_RATIO; }
+        size_t min_mines = 0, max_mines = 0;
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            const Component& comp = comps_[c];
+            size_t lo = 0, hi = comp_vars_[c].size();
+            // the paths sampled may miss the extremes
+            while (!comp.sampled && comp.count[lo] == 0.0) { lo++; }
+            while (!comp.sampled && comp.count[hi] == 0.0) { hi--; }
+            min_mines += lo;
+            max_mines += hi;
+        }
+        if (min_mines >= mines_left_) { return 0.0; }
+        if (max_mines + num_of_interior_ <= mines_left_) { return 1.0; }
+        double p = (mines_left_ - expected) / num_of_interior_;
+        return std::min(1.0 - INTERIOR_PROB_MARGIN, std::max(INTERIOR_PROB_MARGIN, p));
+    }
+
+    // The exact weights, once the mine count is known. Solutions with
+    // k mines in component c go with every way the other components
+    // take s mines and the interior the rest:
+    //     weight[k] = sum(others[s] * C(interior, mines_left - k - s))
+    // where others is the convolution of the other components' counts,
+    // made from prefix and suffix convolutions. Counts and binomials
+    // grow past a double, so all of it is in log space; the weights of
+    // a component only matter relative to each other.
+    // returns false if no solution fits the mine count
+    bool global_weights() {
+        prefix_.resize(num_of_comp_ + 1);
+        suffix_.resize(num_of_comp_ + 1);
+        log_count_.resize(num_of_comp_);
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            log_count_[c].clear();
+            for (double cnt : comps_[c].count) {
+                log_count_[c].push_back(cnt > 0.0 ? std::log(cnt) : LOG_ZERO);
+            }
+        }
+        prefix_[0].assign(1, 0.0);
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            log_convolve(prefix_[c], log_count_[c], prefix_[c + 1]);
+        }
+        suffix_[num_of_comp_].assign(1, 0.0);
+        for (size_t c = num_of_comp_; c-- > 0; ) {
+            log_convolve(log_count_[c], suffix_[c + 1], suffix_[c]);
+        }
+
+        const std::vector<double>& all = prefix_[num_of_comp_];
+        double log_total = LOG_ZERO, log_interior = LOG_ZERO;
+        for (size_t s = 0; s < all.size(); s++) {
+            long rest = static_cast<long>(mines_left_) - static_cast<long>(s);
+            log_total = log_add(log_total, all[s] + log_choose(num_of_interior_, rest));
+            // C(n, m) * m / n = C(n - 1, m - 1): an interior tile is a mine
+            if (num_of_interior_ > 0) {
+                log_interior = log_add(log_interior,
+                    all[s] + log_choose(num_of_interior_ - 1, rest - 1));
+            }
+        }
+        if (log_total == LOG_ZERO) return false;  // the mines left fit no layout
+        endgame_interior_prob_ = std::exp(log_interior - log_total);
+
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            log_convolve(prefix_[c], suffix_[c + 1], others_);
+            size_t n = comp_vars_[c].size();
+            std::vector<double>& weight = comps_[c].weight;
+            weight.assign(n + 1, LOG_ZERO);
+            double max_weight = LOG_ZERO;
+            for (size_t k = 0; k <= n; k++) {
+                for (size_t s = 0; s < others_.size(); s++) {
+                    long rest = static_cast<long>(mines_left_) - static_cast<long>(k + s);
+                    weight[k] = log_add(weight[k],
+                        others_[s] + log_choose(num_of_interior_, rest));
+                }
+                max_weight = std::max(max_weight, weight[k]);
+            }
+            for (double& w : weight) {
+                w = w == LOG_ZERO ? 0.0 : std::exp(w - max_weight);
+            }
+        }
+        return true;
+    }
+
+    static constexpr double LOG_ZERO = -std::numeric_limits<double>::infinity();
+
+    // log(exp(a) + exp(b))
+    static double log_add(double a, double b) {
+        if (a < b) { std::swap(a, b); }
+        if (b == LOG_ZERO) { return a; }
+        return a + std::log1p(std::exp(b - a));
+    }
+    static double log_choose(size_t n, long k) {
+        if (k < 0 || k > static_cast<long>(n)) { return LOG_ZERO; }
+        return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+    }
+    static void log_convolve(const std::vector<double>& a, const std::vector<double>& b,
+                             std::vector<double>& out) {
+        out.assign(a.size() + b.size() - 1, LOG_ZERO);
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i] == LOG_ZERO) continue;
+            for (size_t j = 0; j < b.size(); j++) {
+                out[i + j] = log_add(out[i + j], a[i] + b[j]);
+            }
+        }
+    }
+
+    static constexpr double INTERIOR_PROB_MARGIN = 1e-6;
+    static constexpr size_t CLOCK_STEPS = 4096;     // nodes between clock reads
+    static constexpr size_t MAX_SAMPLE_ROUNDS = 64; // of SOLVER_MIN_SAMPLES, past the deadline
+
+    std::chrono::microseconds budget_{0};
+    std::chrono::steady_clock::time_point exact_deadline_;
+    std::chrono::steady_clock::time_point deadline_;
+    mutable std::atomic<bool> expired_{false};
+    Xoshiro256 rng_;  // for sample_path()
+    Sample sample_;
+    std::vector<size_t> sampled_;
+    size_t num_of_sampled_ = 0;
+    size_t num_of_sample_ = 0;
+    double max_stderr_ = 0.0;
+
+    int mines_left_ = -1;
+    std::vector<Component> comps_;
+    WorkStealingPool* pool_ = nullptr;
+    std::vector<Slot> slots_;
+    std::vector<size_t> acc_offset_;  // of each component in Slot::acc
+    std::vector<Subtree> subtrees_;
+
+    size_t endgame_unknowns_ = SOLVER_ENDGAME_UNKNOWNS;
+    bool is_endgame_ = false;
+    double endgame_interior_prob_ = 0.0;
+    std::vector<std::vector<double>> log_count_;  // see global_weights()
+    std::vector<std::vector<double>> prefix_;
+    std::vector<std::vector<double>> suffix_;
+    std::vector<double> others_;
+
+    std::vector<double> prob_;
+    double interior_prob_ = 0.0;
+    size_t num_of_interior_ = 0;
+};  // endof class FrontierSolver
+
+// Certain tiles of a visible position by elimination, no enumeration.
+//
+// The constraints of each component are rows of small integers over
+// its vars. A row whose right side is the largest (smallest) sum its
+// coefficients allow forces every var: mines under the positive
+// (negative) ones, the others safe. Gauss-Jordan elimination on the
+// rows brings out such combinations, e.g. the difference of two
+// numbers sharing most of their neighbors.
+//
+// The constraints are over the integers, so GF(2) rows would lose
+// them: a row keeps its coefficients bit-sliced instead, in PLANES
+// words of 4-bit two's complement lanes per 64 vars, and adding two
+// rows is a ripple carry across the planes, whole words at a time.
+// A combination that would overflow a lane is skipped, which only
+// leaves a row less reduced, never wrong.
+class LinearDeduction : public FrontierConstraints {
+public:
+    // status: cell_status() codes of height * width tiles, row-major,
+    // returns whether any tile was found certain
+    bool deduce(const uint8_t* status, size_t height, size_t width) {
+        build(status, height, width);
+        safe_.clear();
+        mines_.clear();
+        certain_.assign(frontier_.size(), 0);
+        local_.resize(frontier_.size());
+        if (comp_cons_.size() < num_of_comp_) { comp_cons_.resize(num_of_comp_); }
+        for (size_t c = 0; c < num_of_comp_; c++) { comp_cons_[c].clear(); }
+        for (size_t k = 0; k < cons_.size(); k++) {
+            comp_cons_[comp_of(cons_vars_[cons_[k].var_begin])].push_back(k);
+        }
+        for (size_t c = 0; c < num_of_comp_; c++) {
+            reduce(c);
+        }
+        return !safe_.empty() || !mines_.empty();
+    }
+
+    // tile indices found by the last deduce()
+    const std::vector<size_t>& safe() const {
+        return safe_;
+    }
+    const std::vector<size_t>& mines() const {
+        return mines_;
+    }
+
+private:
+    static constexpr size_t PLANES = 4;  // lanes hold -8 ~ 7
+    static constexpr int MAX_COEF = 7;
+
+    uint64_t* row(size_t r) {
+        return rows_.data() + r * PLANES * words_;
+    }
+    int coef(size_t r, size_t k) {
+        const uint64_t* cur = row(r) + k / 64;
+        size_t bit = k % 64;
+        int value = 0;
+        for (size_t b = 0; b < PLANES; b++) {
+            value |= static_cast<int>(cur[b * words_] >> bit & 1) << b;
+        }
+        return value >= 1 << (PLANES - 1) ? value - (1 << PLANES) : value;
+    }
+
+    // dst = x + y (or x - y), lane by lane; false on an overflow
+    bool add_row(uint64_t* dst, const uint64_t* x, const uint64_t* y, bool sub) {
+        uint64_t overflow = 0;
+        uint64_t flip = sub ? ~0ULL : 0ULL;
+        for (size_t w = 0; w < words_; w++) {
+            uint64_t carry = flip;  // x + ~y + 1 for a subtraction
+            for (size_t b = 0; b < PLANES; b++) {
+                uint64_t a = x[b * words_ + w];
+                uint64_t c = y[b * words_ + w] ^ flip;
+                dst[b * words_ + w] = a ^ c ^ carry;
+                uint64_t next = (a & c) | (carry & (a ^ c));
+                if (b == PLANES - 1) { overflow |= carry ^ next; }
+                carry = next;
+            }
+            // the padding lanes stay zero
+            if (w == words_ - 1) {
+                for (size_t b = 0; b < PLANES; b++) { dst[b * words_ + w] &= last_mask_; }
+                overflow &= last_mask_;
+            }
+        }
+        return overflow == 0;
+    }
+    // row r -= times * pivot row p, kept as it was on an overflow
+    void eliminate(size_t r, size_t p, int times) {
+        bool sub = times > 0;
+        uint64_t* tmp = tmp_.data();
+        std::copy(row(r), row(r) + PLANES * words_, tmp);
+        for (int k = 0; k < std::abs(times); k++) {
+            if (!add_row(tmp, tmp, row(p), sub)) return ;
+        }
+        int rhs = rhs_[r] - times * rhs_[p];
+        if (std::abs(rhs) > MAX_COEF * static_cast<int>(num_of_local_)) return ;
+        std::copy(tmp, tmp + PLANES * words_, row(r));
+        rhs_[r] = rhs;
+    }
+    // false if some lane holds -8, the row kept as it was
+    bool negate(size_t r) {
+        zero_.assign(PLANES * words_, 0);
+        if (!add_row(tmp_.data(), zero_.data(), row(r), true)) return false;
+        std::copy(tmp_.begin(), tmp_.end(), row(r));
+        rhs_[r] = -rhs_[r];
+        return true;
+    }
+
+    // the bounds of a row, from popcounts of its planes
+    void check_bounds(size_t r) {
+        const uint64_t* cur = row(r);
+        const uint64_t* sign = cur + (PLANES - 1) * words_;
+        int max_sum = 0, min_sum = 0;
+        for (size_t w = 0; w < words_; w++) {
+            for (size_t b = 0; b + 1 < PLANES; b++) {
+                uint64_t plane = cur[b * words_ + w];
+                max_sum += __builtin_popcountll(plane & ~sign[w]) << b;
+                min_sum += __builtin_popcountll(plane & sign[w]) << b;
+            }
+            min_sum -= __builtin_popcountll(sign[w]) << (PLANES - 1);
+        }
+        bool at_max = rhs_[r] == max_sum, at_min = rhs_[r] == min_sum;
+        if (!at_max && !at_min) return ;  // also a row nothing satisfies
+        for (size_t w = 0; w < words_; w++) {
+            uint64_t nonzero = 0;
+            for (size_t b = 0; b < PLANES; b++) { nonzero |= cur[b * words_ + w]; }
+            uint64_t mine = at_max ? nonzero & ~sign[w] : nonzero & sign[w];
+            while (nonzero) {
+                size_t bit = __builtin_ctzll(nonzero);
+                nonzero &= nonzero - 1;
+                mark(comp_vars_[comp_][w * 64 + bit], mine >> bit & 1);
+            }
+        }
+    }
+    void mark(size_t var, bool is_mine) {
+        if (certain_[var]) return ;
+        certain_[var] = 1;
+        (is_mine ? mines_ : safe_).push_back(frontier_[var]);
+    }
+
+    void reduce(size_t c) {
+        const std::vector<size_t>& vars = comp_vars_[c];
+        const std::vector<size_t>& cons = comp_cons_[c];
+        comp_ = c;
+        num_of_local_ = vars.size();
+        words_ = (num_of_local_ + 63) / 64;
+        last_mask_ = num_of_local_ % 64 ? (1ULL << num_of_local_ % 64) - 1 : ~0ULL;
+        for (size_t k = 0; k < vars.size(); k++) { local_[vars[k]] = k; }
+        rows_.assign(cons.size() * PLANES * words_, 0);
+        tmp_.resize(PLANES * words_);
+        rhs_.resize(cons.size());
+        for (size_t r = 0; r < cons.size(); r++) {
+            const Constraint& cur = cons_[cons[r]];
+            for (size_t j = cur.var_begin; j < cur.var_end; j++) {
+                size_t k = local_[cons_vars_[j]];
+                row(r)[k / 64] |= 1ULL << k % 64;  // coefficient 1
+            }
+            rhs_[r] = cur.needed;
+            check_bounds(r);
+        }
+        size_t rank = 0;
+        for (size_t k = 0; k < num_of_local_ && rank < cons.size(); k++) {
+            size_t pivot = cons.size();
+            for (size_t r = rank; r < cons.size(); r++) {
+                if (std::abs(coef(r, k)) == 1) { pivot = r; break; }
+            }
+            if (pivot == cons.size()) continue;
+            if (pivot != rank) {
+                std::swap_ranges(row(pivot), row(pivot) + PLANES * words_, row(rank));
+                std::swap(rhs_[pivot], rhs_[rank]);
+            }
+            if (coef(rank, k) < 0 && !negate(rank)) continue;
+            for (size_t r = 0; r < cons.size(); r++) {
+                if (r == rank) continue;
+                int times = coef(r, k);
+                if (times != 0) { eliminate(r, rank, times); }
+            }
+            rank++;
+        }
+        for (size_t r = 0; r < cons.size(); r++) {
+            check_bounds(r);
+        }
+    }
+
+    std::vector<std::vector<size_t>> comp_cons_;  // constraints of each component
+    std::vector<size_t> local_;     // var -> its lane in the component
+    std::vector<uint64_t> rows_;    // (row, plane, word)
+    std::vector<uint64_t> tmp_;
+    std::vector<uint64_t> zero_;
+    std::vector<int> rhs_;
+    size_t comp_ = 0;
+    size_t num_of_local_ = 0;
+    size_t words_ = 0;
+    uint64_t last_mask_ = 0;
+
+    std::vector<uint8_t> certain_;  // per var
+    std::vector<size_t> safe_;
+    std::vector<size_t> mines_;
+};  // endof class LinearDeduction
+
+}  // endof namespace mfwu
+
+#endif  // __SOLVER_HPP__
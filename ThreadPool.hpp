@@ -0,0 +1,184 @@
+#ifndef __THREADPOOL_HPP__
+#define __THREADPOOL_HPP__
+
+#include "common.hpp"
+
+namespace mfwu {
+
+// Tasks submitted together and waited for together, see WorkStealingPool
+class TaskGroup {
+public:
+    TaskGroup() = default;
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    bool done() const {
+        return pending_.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class WorkStealingPool;
+    std::atomic<size_t> pending_{0};
+};  // endof class TaskGroup
+
+// Every worker owns a deque: it pushes and pops at the back, and when
+// it runs dry it steals from the front of the others, so the oldest,
+// usually largest, tasks are the ones that move between threads.
+// A thread waiting for a group runs queued tasks meanwhile instead of
+// blocking, so the pool works with no worker at all, and a task may
+// itself submit and wait.
+//
+// Usage:
+//     TaskGroup group;
+//     for (...) { pool.submit(group, [&] { ... }); }
+//     pool.wait(group);
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(size_t num_of_worker)
+        : queues_(num_of_worker + 1) {
+        for (size_t k = 0; k < num_of_worker; k++) {
+            workers_.emplace_back(&WorkStealingPool::work, this, k);
+        }
+    }
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mtx_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t num_of_worker() const {
+        return workers_.size();
+    }
+    // 0 ~ num_of_worker() - 1 on the workers, num_of_worker() elsewhere:
+    // an index for per-thread scratch, one outside caller at a time
+    size_t current_slot() const {
+        return worker_pool() == this ? worker_index() : workers_.size();
+    }
+
+    void submit(TaskGroup& group, Task task) {
+        group.pending_.fetch_add(1, std::memory_order_relaxed);
+        // counted first, so that it never drops below the queued tasks
+        queued_.fetch_add(1, std::memory_order_release);
+        Queue& queue = queues_[current_slot()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mtx);
+            queue.tasks.push_back({std::move(task), &group});
+        }
+        // a worker between its check and its wait still hears this
+        { std::lock_guard<std::mutex> lock(sleep_mtx_); }
+        wake_.notify_one();
+    }
+    // runs queued tasks until every task of group is done,
+    // NOTE: a task using current_slot() scratch must not wait itself
+    void wait(TaskGroup& group) {
+        size_t slot = current_slot();
+        while (!group.done()) {
+            if (!run_one(slot)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    struct Item {
+        Task task;
+        TaskGroup* group;
+    };  // endof struct Item
+    struct Queue {
+        std::mutex mtx;
+        std::deque<Item> tasks;
+    };  // endof struct Queue
+
+    static const WorkStealingPool*& worker_pool() {
+        static thread_local const WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+    static size_t& worker_index() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    // its own queue from the back, then the others from the front
+    bool pop(size_t slot, Item& item) {
+        {
+            Queue& queue = queues_[slot];
+            std::lock_guard<std::mutex> lock(queue.mtx);
+            if (!queue.tasks.empty()) {
+                item = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues_.size(); k++) {
+            Queue& queue = queues_[(slot + k) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mtx);
+            if (!queue.tasks.empty()) {
+                item = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+    bool run_one(size_t slot) {
+        if (queued_.load(std::memory_order_acquire) == 0) return false;
+        Item item;
+        if (!pop(slot, item)) return false;
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        item.task();
+        item.group->pending_.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+    void work(size_t index) {
+        worker_pool() = this;
+        worker_index() = index;
+        while (true) {
+            if (run_one(index)) continue;
+            std::unique_lock<std::mutex> lock(sleep_mtx_);
+            wake_.wait(lock, [this] {
+                return stop_ || queued_.load(std::memory_order_acquire) > 0;
+            });
+            if (stop_) return ;
+        }
+    }
+
+    std::vector<Queue> queues_;  // one per worker, the last for outside callers
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_{0};
+    std::mutex sleep_mtx_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};  // endof class WorkStealingPool
+
+// the pool the robots share, started on first use
+inline WorkStealingPool& solver_pool() {
+    static WorkStealingPool pool(SOLVER_POOL_WORKERS > 0 ? SOLVER_POOL_WORKERS
+        : std::max(1U, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+inline bool& robot_pool_setting() {
+    static bool use_pool = true;
+    return use_pool;
+}
+// off when the games themselves run in parallel, see sim.cc,
+// every robot made afterwards then solves on its own thread
+inline void set_robot_pool(bool use_pool) {
+    robot_pool_setting() = use_pool;
+}
+inline bool robot_pool() {
+    return robot_pool_setting();
+}
+
+}  // endof namespace mfwu
+
+#endif  // __THREADPOOL_HPP__
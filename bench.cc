@@ -0,0 +1,385 @@
+#include "common.hpp"
+#include "GameController.hpp"
+using namespace mfwu;
+
+// board without terminal io, so that we only time the storage engine
+template <BoardSize Size, template <BoardSize> class Engine=Board>
+class BenchBoard final : public Engine<Size> {
+public:
+    template <typename... Args>
+    BenchBoard(Args&&... args) : Engine<Size>(std::forward<Args>(args)...) {}
+    Command get_command() override { return {CommandType::QUIT, {}}; }
+    void show() const override {}
+    void show_mine_num() const override {}
+    void show_without_log() const override {}
+    void refresh() override {}
+};  // endof class BenchBoard
+
+using bench_clock = std::chrono::steady_clock;
+
+inline double elapsed_us(bench_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(bench_clock::now() - start).count();
+}
+
+// every number printed below, also written out by --json <file>, so
+// that runs of different releases can be compared
+struct BenchResult {
+    std::string bench;
+    std::string board;
+    std::string metric;
+    double value;
+    std::string unit;
+};  // endof struct BenchResult
+
+std::vector<BenchResult>& bench_results() {
+    static std::vector<BenchResult> results;
+    return results;
+}
+void report(const char* bench, const char* board, const char* metric,
+            double value, const char* unit="us") {
+    bench_results().push_back({bench, board, metric, value, unit});
+}
+bool write_json(const char* filename) {
+    FILE* fp = fopen(filename, "w");
+    if (fp == nullptr) { return false; }
+    fprintf(fp, "{\n  \"threads\": %u,\n  \"results\": [", std::thread::hardware_concurrency());
+    const std::vector<BenchResult>& results = bench_results();
+    for (size_t k = 0; k < results.size(); k++) {
+        const BenchResult& res = results[k];
+        fprintf(fp, "%s\n    {\"bench\": \"%s\", \"board\": \"%s\", \"metric\": \"%s\", "
+                "\"value\": %.6g, \"unit\": \"%s\"}", k ? "," : "", res.bench.c_str(),
+                res.board.c_str(), res.metric.c_str(), res.value, res.unit.c_str());
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    return fclose(fp) == 0;
+}
+
+template <typename Board_type>
+std::vector<Position> safe_positions(const Board_type& board) {
+    std::vector<Position> ret;
+    for (int i = 0; i < board.height(); i++) {
+        for (int j = 0; j < board.width(); j++) {
+            if (!board.get_tile(i, j).is_mine()) {
+                ret.emplace_back(i, j);
+            }
+        }
+    }
+    return ret;
+}
+
+template <BoardSize Size, template <BoardSize> class Engine=Board, typename... Args>
+void bench_board(const char* bench, const char* name, int rounds, Args... args) {
+    auto start = bench_clock::now();
+    for (int k = 0; k < rounds; k++) {
+        BenchBoard<Size, Engine> fresh(args...);
+    }
+    double construct_us = elapsed_us(start) / rounds;
+
+    BenchBoard<Size, Engine> board(args...);
+    start = bench_clock::now();
+    for (int k = 0; k < rounds; k++) {
+        board.reset();
+    }
+    double init_us = elapsed_us(start) / rounds;
+
+    // a board without mines opens in one flood fill
+    const BenchBoard<Size, Engine> open_board(std::vector<std::vector<bool>>(
+        board.height(), std::vector<bool>(board.width(), false)));
+    double flood_us = 0.0;
+    for (int k = 0; k < rounds / 10 + 1; k++) {
+        BenchBoard<Size, Engine> opened = open_board;
+        start = bench_clock::now();
+        opened.update({CommandType::REVEAL, {0, 0}});
+        flood_us += elapsed_us(start);
+    }
+    flood_us /= rounds / 10 + 1;
+
+    double reveal_us = 0.0;
+    for (int k = 0; k < rounds; k++) {
+        board.reset();
+        std::vector<Position> safe = safe_positions(board);
+        start = bench_clock::now();
+        for (const Position& pos : safe) {
+            board.update({CommandType::REVEAL, pos});
+        }
+        reveal_us += elapsed_us(start);
+    }
+    reveal_us /= rounds;
+
+    // every move on CmdBoard also patches the displayer
+    CmdBoard<Size, Engine> cmd_board(args...);
+    double display_us = 0.0;
+    size_t display_cnt = 0;
+    for (int k = 0; k < rounds / 10 + 1; k++) {
+        cmd_board.reset();
+        std::vector<Position> safe = safe_positions(cmd_board);
+        start = bench_clock::now();
+        for (const Position& pos : safe) {
+            cmd_board.update({CommandType::REVEAL, pos});
+        }
+        display_us += elapsed_us(start);
+        display_cnt += safe.size();
+    }
+    display_us /= display_cnt;
+
+    // what CmdBoard::reseed() adds to the board's own
+    start = bench_clock::now();
+    for (int k = 0; k < rounds / 10 + 1; k++) {
+        cmd_board.rebuild_displayer();
+    }
+    double snap_us = elapsed_us(start) / (rounds / 10 + 1);
+
+    // recording a frame: a fresh string vs the reusable 4-bit buffer
+    size_t sink = 0;
+    start = bench_clock::now();
+    for (int k = 0; k < rounds; k++) {
+        sink += board.serialize().size();
+    }
+    double string_us = elapsed_us(start) / rounds;
+    std::vector<uint8_t> frame(board.packed_size());
+    start = bench_clock::now();
+    for (int k = 0; k < rounds; k++) {
+        board.serialize_packed(frame.data());
+        sink += frame[k % frame.size()];
+    }
+    double packed_us = elapsed_us(start) / rounds;
+
+    printf("%-8s new: %9.2f us  init: %9.2f us  reveal(all): %9.2f us  flood: %9.2f us"
+           "  display(per move): %7.3f us  snap+rebuild: %9.2f us"
+           "  frame(string/packed): %7.3f / %7.3f us%s\n",
+           name, construct_us, init_us, reveal_us, flood_us, display_us, snap_us,
+           string_us, packed_us, sink ? "" : " ");
+    report(bench, name, "construct", construct_us);
+    report(bench, name, "reset", init_us);
+    report(bench, name, "reveal_all", reveal_us);
+    report(bench, name, "reveal_open_board", flood_us);
+    report(bench, name, "display_per_move", display_us);
+    report(bench, name, "snap_reconstruct", snap_us);
+    report(bench, name, "serialize_string", string_us);
+    report(bench, name, "serialize_packed", packed_us);
+}
+
+// the per-tile path init_tile_num() used before the kernels
+void count_by_dirs(const uint8_t* mines, uint8_t* cells, size_t height, size_t width) {
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            if (mines[i * width + j]) { cells[i * width + j] = MINE; continue; }
+            int res = 0;
+            for (auto&& [inc_r, inc_c] : dirs) {
+                int cur_r = i + inc_r, cur_c = j + inc_c;
+                if (cur_r < 0 || cur_r >= height || cur_c < 0 || cur_c >= width) { continue; }
+                res += mines[cur_r * width + cur_c] != 0;
+            }
+            cells[i * width + j] = res;
+        }
+    }
+}
+
+void bench_kernel(const char* name, size_t height, size_t width, int rounds) {
+    size_t num_of_tile = height * width;
+    std::vector<uint8_t> mines(num_of_tile), expected(num_of_tile), cells(num_of_tile);
+    std::vector<uint8_t> scratch(neighbor_scratch_size(height, width));
+    for (uint8_t& m : mines) { m = rand() % 5 == 0 ? MINE : 0; }
+
+    auto start = bench_clock::now();
+    for (int k = 0; k < rounds; k++) {
+        count_by_dirs(mines.data(), expected.data(), height, width);
+    }
+    double dirs_us = elapsed_us(start) / rounds;
+    printf("%-8s dirs: %8.3f us", name, dirs_us);
+    report("init_tile_num", name, "dirs", dirs_us);
+
+    for (NeighborKernel kernel : {NeighborKernel::SCALAR, NeighborKernel::SSE2, NeighborKernel::AVX2}) {
+        if (!is_kernel_supported(kernel)) { continue; }
+        start = bench_clock::now();
+        for (int k = 0; k < rounds; k++) {
+            count_neighbor_mines(mines.data(), cells.data(), height, width, scratch.data(), kernel);
+        }
+        double us = elapsed_us(start) / rounds;
+        const char* kernel_name = NeighborKernelDescription.at(static_cast<size_t>(kernel)).c_str();
+        printf("  %s: %8.3f us", kernel_name, us);
+        report("init_tile_num", name, kernel_name, us);
+        if (cells != expected) {
+            printf("  MISMATCH");
+        }
+    }
+    printf("\n");
+}
+
+// scattered openings on a 30x30 board make wide frontier components
+void bench_solver(const char* name, int positions) {
+    const size_t height = 30, width = 30;
+    FrontierSolver serial, parallel, budgeted;
+    parallel.set_pool(&solver_pool());
+    budgeted.set_budget(std::chrono::microseconds(SOLVER_MOVE_BUDGET_US));
+    std::vector<uint8_t> status(height * width);
+    double serial_ms = 0.0, parallel_ms = 0.0, budgeted_ms = 0.0, max_stderr = 0.0;
+    size_t largest = 0, sampled = 0;
+    for (int k = 0; k < positions; k++) {
+        BenchBoard<BoardSize::Custom> board(height, width, 0.16F);
+        board.reseed(k + 1);
+        Xoshiro256 rng(k);
+        for (int m = 0; m < 16; m++) {
+            int row = rng.bounded(height), col = rng.bounded(width);
+            if (!board.get_tile(row, col).is_mine()) {
+                board.update({CommandType::REVEAL, {row, col}});
+            }
+        }
+        for (size_t idx = 0; idx < height * width; idx++) {
+            status[idx] = tile_status(board.get_tile(idx / width, idx % width));
+        }
+        auto start = bench_clock::now();
+        serial.solve(status.data(), height, width, board.mines_left());
+        serial_ms += elapsed_us(start) / 1000;
+        start = bench_clock::now();
+        parallel.solve(status.data(), height, width, board.mines_left());
+        parallel_ms += elapsed_us(start) / 1000;
+        start = bench_clock::now();
+        budgeted.solve(status.data(), height, width, board.mines_left());
+        budgeted_ms = std::max(budgeted_ms, elapsed_us(start) / 1000);
+        sampled += !budgeted.is_exact();
+        max_stderr = std::max(max_stderr, budgeted.max_stderr());
+        largest = std::max(largest, serial.largest_component());
+    }
+    printf("%-8s serial: %8.2f ms  %lu threads: %8.2f ms  (largest component %lu)\n",
+           name, serial_ms / positions, solver_pool().num_of_worker() + 1,
+           parallel_ms / positions, largest);
+    printf("%-8s budget %lu us: worst %6.2f ms, %lu of %d sampled, stderr up to %.3f\n",
+           name, SOLVER_MOVE_BUDGET_US, budgeted_ms, sampled, positions, max_stderr);
+    report("solver", name, "serial", serial_ms / positions, "ms");
+    report("solver", name, "parallel", parallel_ms / positions, "ms");
+    report("solver", name, "budgeted_worst", budgeted_ms, "ms");
+}
+
+// HumanLikeRobot games until it wins, loses or has to ask,
+// timing every play(), its get_best_cmd() with the moves it places
+template <BoardSize Size>
+void bench_robot(const char* name, int games) {
+    auto board = std::make_shared<BenchBoard<Size>>();
+    HumanLikeRobot robot(board);
+    Player<BenchBoard<Size>>& player = robot;
+    double play_us = 0.0, worst_us = 0.0;
+    size_t plays = 0, moves = 0;
+    for (int k = 0; k < games; k++) {
+        board->reseed(k + 1);
+        player.reset();
+        int res = 0;
+        while (res == 0) {
+            auto start = bench_clock::now();
+            Command cmd = player.play();
+            double us = elapsed_us(start);
+            if (cmd.cmdtype == CommandType::BATCH) {
+                moves += player.get_last_batch().size();
+                cmd = player.get_last_batch().back();
+            } else if (cmd.cmdtype == CommandType::REVEAL || cmd.cmdtype == CommandType::FLAG) {
+                moves++;
+            } else {
+                break;  // stuck, asked the board
+            }
+            play_us += us;
+            worst_us = std::max(worst_us, us);
+            plays++;
+            res = board->is_end(cmd.pos.row, cmd.pos.col);
+        }
+    }
+    printf("%-8s play: %8.2f us  worst: %9.2f us  (%lu moves in %lu plays)\n",
+           name, play_us / plays, worst_us, moves, plays);
+    report("robot", name, "play", play_us / plays);
+    report("robot", name, "play_worst", worst_us);
+    report("robot", name, "move", play_us / moves);
+}
+
+// a game of frames, one reveal each, flushed to a scratch file
+template <BoardSize Size>
+void bench_archive(const char* name, int games) {
+    std::string filename = (std::filesystem::temp_directory_path() / "mfwu_bench.arc").string();
+    double flush_us = 0.0;
+    size_t frames = 0;
+    {
+        Archive<BenchBoard<Size>> archive(filename);
+        BenchBoard<Size> board;
+        MoveLog moves;
+        for (int k = 0; k < games; k++) {
+            board.reseed(k + 1);
+            archive.set_seed(board.get_seed());
+            moves.clear();
+            for (const Position& pos : safe_positions(board)) {
+                if (board.get_tile(pos.row, pos.col).get_cover() == Cover::REVEALED) { continue; }
+                Command cmd = {CommandType::REVEAL, pos};
+                board.update(cmd);
+                moves.push_frame(&cmd, 1);
+                uint8_t* frame = archive.new_packed_frame(board.frame_height(),
+                                                          board.frame_width(), board.zobrist());
+                if (frame != nullptr) { board.serialize_packed(frame); }
+            }
+            frames += moves.num_of_frame;
+            auto start = bench_clock::now();
+            archive.flush(GameStatus::NORMAL, &moves);
+            flush_us += elapsed_us(start);
+        }
+    }
+    std::filesystem::remove(filename);
+    printf("%-8s flush: %9.2f us a game  %7.3f us a frame\n",
+           name, flush_us / games, flush_us / frames);
+    report("archive", name, "flush_game", flush_us / games);
+    report("archive", name, "flush_frame", flush_us / frames);
+}
+
+// a board-sized message a call, every call flushes the log file
+template <BoardSize Size>
+void bench_logger(const char* name, int rounds) {
+    BenchBoard<Size> board;
+    std::string frame = board.serialize();
+    auto start = bench_clock::now();
+    for (int k = 0; k < rounds; k++) {
+        log_debug("bench frame %d:\n%s", k, frame.c_str());
+    }
+    double log_us = elapsed_us(start) / rounds;
+    printf("%-8s log: %8.3f us  (%lu bytes)\n", name, log_us, frame.size());
+    report("logger", name, "log_flush", log_us);
+}
+
+// usage: ./bench [--json <file>]
+int main(int argc, char* argv[]) {
+    const char* json_filename = nullptr;
+    if (argc == 3 && std::string(argv[1]) == "--json") {
+        json_filename = argv[2];
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [--json <file>]\n", argv[0]);
+        return 1;
+    }
+    srand(0);
+    bench_board<BoardSize::Small>("board", "Small", 2000);
+    bench_board<BoardSize::Middle>("board", "Middle", 1000);
+    bench_board<BoardSize::Large>("board", "Large", 500);
+    bench_board<BoardSize::Custom>("board", "Custom", 500, size_t(20), size_t(26), MINE_POS_RATIO);
+    bench_board<BoardSize::Custom>("board", "256x256", 20, size_t(256), size_t(256), MINE_POS_RATIO);
+    printf("BitBoard:\n");
+    bench_board<BoardSize::Small, BitBoard>("bitboard", "Small", 2000);
+    bench_board<BoardSize::Middle, BitBoard>("bitboard", "Middle", 1000);
+    bench_board<BoardSize::Large, BitBoard>("bitboard", "Large", 500);
+    printf("Neighbor count kernels:\n");
+    bench_kernel("Small", 12, 9, 20000);
+    bench_kernel("Middle", 18, 15, 20000);
+    bench_kernel("Large", 20, 26, 20000);
+    bench_kernel("256x256", 256, 256, 200);
+    printf("Frontier solver:\n");
+    bench_solver("30x30", 20);
+    printf("HumanLikeRobot:\n");
+    bench_robot<BoardSize::Small>("Small", 300);
+    bench_robot<BoardSize::Middle>("Middle", 200);
+    bench_robot<BoardSize::Large>("Large", 100);
+    printf("Archive:\n");
+    bench_archive<BoardSize::Small>("Small", 200);
+    bench_archive<BoardSize::Middle>("Middle", 100);
+    bench_archive<BoardSize::Large>("Large", 50);
+    printf("Logger:\n");
+    bench_logger<BoardSize::Small>("Small", 2000);
+    bench_logger<BoardSize::Middle>("Middle", 2000);
+    bench_logger<BoardSize::Large>("Large", 2000);
+    if (json_filename != nullptr && !write_json(json_filename)) {
+        fprintf(stderr, "cannot write %s\n", json_filename);
+        return 1;
+    }
+    return 0;
+}
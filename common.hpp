@@ -12,7 +12,9 @@ namespace mfwu {
 enum class BoardSize : size_t {
     Small = 0,
     Middle = 1,
-    Large = 2
+    Large = 2,
+    Custom = 3,  // dimensions and mine ratio given at runtime
+    Infinite = 4 // chunked, see ChunkBoard.hpp
 };  // endof enum class BoardSize
 
 struct BoardDimension {
@@ -25,6 +27,78 @@ constexpr BoardDimension get_board_dimension(BoardSize sz) {
     return BoardSize2Dimension[static_cast<size_t>(sz)];
 }
 
+// Dimensions of a board, compile-time for the presets.
+// Use them through this-> or using-declarations, so that
+// the same code also works with BoardSize::Custom.
+template <BoardSize Size>
+struct BoardDims {
+    static constexpr BoardDimension dims = get_board_dimension(Size);
+    static constexpr size_t height_ = dims.height;
+    static constexpr size_t width_  = dims.width;
+    static constexpr size_t num_of_tile_ = width_ * height_;
+    static constexpr size_t num_of_mine_ = num_of_tile_ * MINE_POS_RATIO;
+    // frame sizes, see serialize_cells() / pack_cells()
+    static constexpr size_t serialized_size_ = height_ * (2 * width_ + 1);
+    static constexpr size_t packed_size_ = (num_of_tile_ + 1) / 2;
+
+    BoardDims() = default;
+    BoardDims(size_t height, size_t width, float mine_ratio=MINE_POS_RATIO) {
+        assert(height == height_ && width == width_);
+    }
+};  // endof struct BoardDims
+
+template <>
+struct BoardDims<BoardSize::Custom> {
+    size_t height_;
+    size_t width_;
+    size_t num_of_tile_;
+    size_t num_of_mine_;
+    size_t serialized_size_;
+    size_t packed_size_;
+
+    BoardDims(size_t height, size_t width, float mine_ratio=MINE_POS_RATIO)
+        : height_(height), width_(width), num_of_tile_(height * width),
+          num_of_mine_(std::min<size_t>(num_of_tile_ * mine_ratio, num_of_tile_)),
+          serialized_size_(height * (2 * width + 1)),
+          packed_size_((num_of_tile_ + 1) / 2) {
+        assert(height > 0 && width > 0);
+    }
+};  // endof struct BoardDims<BoardSize::Custom>
+
+// per-tile storage: std::array for the presets, std::vector for Custom
+template <BoardSize Size, typename T>
+struct TileStorage {
+    using type = std::array<T, BoardDims<Size>::num_of_tile_>;
+};  // endof struct TileStorage
+template <typename T>
+struct TileStorage<BoardSize::Custom, T> {
+    using type = std::vector<T>;
+};  // endof struct TileStorage<BoardSize::Custom, T>
+template <BoardSize Size, typename T>
+using tile_storage_t = typename TileStorage<Size, T>::type;
+
+// the narrowest unsigned type holding a tile index
+template <BoardSize Size>
+struct TileIndex {
+    using type = std::conditional_t<(BoardDims<Size>::num_of_tile_ <= 0x10000), 
+                                    uint16_t, uint32_t>;
+};  // endof struct TileIndex
+template <>
+struct TileIndex<BoardSize::Custom> {
+    using type = uint32_t;
+};  // endof struct TileIndex<BoardSize::Custom>
+template <BoardSize Size>
+using tile_index_t = typename TileIndex<Size>::type;
+
+template <typename T, size_t N>
+void resize_storage(std::array<T, N>& storage, size_t n) {
+    assert(n == N);
+}
+template <typename T>
+void resize_storage(std::vector<T>& storage, size_t n) {
+    storage.resize(n);
+}
+
 enum class GameMode : size_t {
     Human,
     Robot
@@ -70,9 +144,18 @@ public:
     int row = -1;
     int col = -1;
 };  // endof struct Position
+// no assumption on the board width
+inline size_t hash_position(int row, int col) {
+    uint64_t key = static_cast<uint64_t>(static_cast<uint32_t>(row)) << 32
+                 | static_cast<uint32_t>(col);
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key);
+}
 struct PositionHash {
     size_t operator()(const Position& pos) const {
-        return static_cast<size_t>(pos.row * 26 + pos.col);
+        return hash_position(pos.row, pos.col);
     }
 };  // endof struct PositionHash
 struct PositionEqual {
@@ -103,8 +186,8 @@ public:
 
 struct PositionPairHash {
     size_t operator()(const PositionPair& pos) const {
-        return static_cast<size_t>((pos.p1.row * 26 + pos.p1.col) * 26 + 
-                                   (pos.p2.row * 26 + pos.p2.col));
+        return hash_position(pos.p1.row, pos.p1.col) * 31
+             ^ hash_position(pos.p2.row, pos.p2.col);
     }
 };  // endof struct PositionPairHash
 struct PositionPairEqual {
@@ -130,13 +213,7 @@ public:
     }
     virtual int get_num() const override { return num; }
     virtual bool is_tile() const override { return true; }
-    virtual bool is_mine() const override {
-        if (num == MINE) {
-            log_warn("Mine constucted in Tile object");
-            return true;
-        }
-        return false;
-    }
+    virtual bool is_mine() const override { return num == MINE; }
     virtual void set_flag() override {
         assert(cover == Cover::COVERED && flag != Flag::INVALID);
         flag == Flag::FLAG ? flag = Flag::NO_FLAG : flag = Flag::FLAG;
@@ -166,6 +243,135 @@ public:
     
 };  // endof struct Mine
 
+// packed one-byte tile, used by the flat storage of Board
+//   bit 0 ~ 3 : number 0 ~ 8, or MINE
+//   bit 4     : revealed
+//   bit 5     : flagged
+using cell_t = uint8_t;
+constexpr cell_t CELL_NUM_MASK = 0x0F;
+constexpr cell_t CELL_REVEALED = 0x10;
+constexpr cell_t CELL_FLAG     = 0x20;
+
+inline int   cell_num(cell_t c)     { return c & CELL_NUM_MASK; }
+inline bool  cell_is_mine(cell_t c) { return (c & CELL_NUM_MASK) == MINE; }
+inline Cover cell_cover(cell_t c)   { return (c & CELL_REVEALED) ? Cover::REVEALED : Cover::COVERED; }
+inline Flag  cell_flag(cell_t c)    { return (c & CELL_FLAG) ? Flag::FLAG : Flag::NO_FLAG; }
+// same encoding as the displayer:
+// number 0 ~ 8, mine 9, unrevealed 0xA, flag 0xF
+inline size_t cell_status(cell_t c) {
+    if (c & CELL_REVEALED) { return cell_num(c); }
+    return (c & CELL_FLAG) ? 0xF : 0xA;
+}
+// the same for a Tile snapshot
+inline size_t tile_status(const Tile& t) {
+    if (t.get_cover() == Cover::REVEALED) { return t.get_num(); }
+    return t.get_flag() == Flag::FLAG ? 0xF : 0xA;
+}
+inline char status_char(size_t status) {
+    return status == 0xA ? '+' : status == 0xF ? 'F'
+         : status == MINE ? 'X' : char('0' + status);
+}
+
+// Frames, written into caller buffers so that recording a move
+// allocates nothing. cell_at(row, col) gives the cell_t of a tile.
+// text: a char and a space per tile, '\n' after every row
+inline size_t serialized_size(size_t height, size_t width) {
+    return height * (2 * width + 1);
+}
+template <typename CellAt>
+void serialize_cells(char* buf, size_t height, size_t width, CellAt&& cell_at) {
+    for (size_t i = 0; i < height; i++) {
+        for (size_t j = 0; j < width; j++) {
+            *buf++ = status_char(cell_status(cell_at(i, j)));
+            *buf++ = ' ';
+        }
+        *buf++ = '\n';
+    }
+}
+// binary: cell_status() codes, 4 bits per tile, low nibble first
+inline size_t packed_size(size_t height, size_t width) {
+    return (height * width + 1) / 2;
+}
+// cell_status() of every cell_t, without the branches
+inline const std::array<uint8_t, 64>& cell_status_table() {
+    static const std::array<uint8_t, 64> table = [] {
+        std::array<uint8_t, 64> ret{};
+        for (size_t c = 0; c < ret.size(); c++) { ret[c] = cell_status(c); }
+        return ret;
+    }();
+    return table;
+}
+// cell_at(k) gives the cell_t of the k-th tile in row-major order
+template <typename CellAt>
+void pack_cells(uint8_t* buf, size_t num_of_tile, CellAt&& cell_at) {
+    const std::array<uint8_t, 64>& status = cell_status_table();
+    size_t k = 0;
+    for (; k + 1 < num_of_tile; k += 2) {
+        *buf++ = status[cell_at(k) & 0x3F] | status[cell_at(k + 1) & 0x3F] << 4;
+    }
+    if (k < num_of_tile) {
+        *buf = status[cell_at(k) & 0x3F];
+    }
+}
+// packed frame back to text, buf holds serialized_size(height, width)
+inline void unpack_cells(char* buf, const uint8_t* packed, size_t height, size_t width) {
+    size_t k = 0;
+    for (size_t i = 0; i < height; i++) {
+        for (size_t j = 0; j < width; j++, k++) {
+            *buf++ = status_char((packed[k >> 1] >> ((k & 1) << 2)) & 0xF);
+            *buf++ = ' ';
+        }
+        *buf++ = '\n';
+    }
+}
+
+// Read-only view of what the player sees, borrowed from the board:
+// the cell_status() code of every tile, row-major. The board keeps the
+// codes in step with every move, undo and redo, so a view stays good
+// for as long as the board lives. Copy it by value, it owns nothing.
+class BoardView {
+public:
+    BoardView() = default;
+    BoardView(const uint8_t* status, size_t height, size_t width)
+        : status_(status), height_(height), width_(width) {}
+
+    // nullptr if the board has no flat storage, see Board_base::view()
+    const uint8_t* data() const { return status_; }
+    size_t height() const { return height_; }
+    size_t width() const { return width_; }
+    size_t size() const { return height_ * width_; }
+
+    size_t index(int row, int col) const {
+        return row * width_ + col;
+    }
+    bool is_valid(int row, int col) const {
+        return row >= 0 && row < height_
+               && col >= 0 && col < width_;
+    }
+    uint8_t operator[](size_t idx) const {
+        return status_[idx];
+    }
+    uint8_t status(int row, int col) const {
+        return status_[index(row, col)];
+    }
+    // covered or flagged
+    bool is_covered(int row, int col) const {
+        return status(row, col) >= 0xA;
+    }
+    bool is_flagged(int row, int col) const {
+        return status(row, col) == 0xF;
+    }
+    // covered and not flagged
+    bool is_rest(int row, int col) const {
+        return status(row, col) == 0xA;
+    }
+
+private:
+    const uint8_t* status_ = nullptr;
+    size_t height_ = 0;
+    size_t width_ = 0;
+};  // endof class BoardView
+
 enum class CommandType : size_t {
     REVEAL = 0,
     FLAG = 1,
@@ -173,11 +379,16 @@ enum class CommandType : size_t {
     MENU = 3,
     QUIT = 4,
     INVALID = 5,
-    XQ4MS = 6
+    XQ4MS = 6,
+    UNDO = 7,
+    REDO = 8,
+    HINT = 9,
+    BATCH = 10
 };  // endof enum class CommandType
 const std::unordered_map<size_t, std::string> CommandTypeDescription = {
     {0, "REVEAL"}, {1, "FLAG"}, {2, "RESTART"},
-    {3, "MENU"}, {4, "QUIT"}, {5, "INVALID"}, {6, "XQ4MS"}
+    {3, "MENU"}, {4, "QUIT"}, {5, "INVALID"}, {6, "XQ4MS"},
+    {7, "UNDO"}, {8, "REDO"}, {9, "HINT"}, {10, "BATCH"}
 };
 
 struct Command {
@@ -186,6 +397,20 @@ public:
     Position pos;
 };  // endof struct Command
 
+// a placed REVEAL or FLAG in 64 bits, for the move log, see Archive.hpp:
+// the flag bit, then row and col in 31 and 32 bits, wide enough for the
+// global coordinates of ChunkBoard
+inline uint64_t pack_move(const Command& cmd) {
+    assert(cmd.pos.row >= 0 && cmd.pos.col >= 0);
+    return (cmd.cmdtype == CommandType::FLAG ? 1ull << 63 : 0ull)
+         | static_cast<uint64_t>(cmd.pos.row) << 32
+         | static_cast<uint64_t>(cmd.pos.col);
+}
+inline Command unpack_move(uint64_t move) {
+    return {move >> 63 ? CommandType::FLAG : CommandType::REVEAL,
+            {static_cast<int>(move >> 32 & 0x7FFFFFFF), static_cast<int>(move & 0xFFFFFFFF)}};
+}
+
 enum class GameStatus : size_t {
     NORMAL = 0,
     RESTART = 2,
@@ -237,6 +462,34 @@ inline bool is_lowercase(char c) {
     return c <= 'z' and c >= 'a';
 }
 
+// row / col labels: A ~ Z, AA ~ AZ, BA ~ ZZ, AAA ...
+inline std::string index2label(size_t idx) {
+    std::string ret;
+    for (idx++; idx > 0; idx = (idx - 1) / 26) {
+        ret += char('A' + (idx - 1) % 26);
+    }
+    std::reverse(ret.begin(), ret.end());
+    return ret;
+}
+// -1 if not a label, case insensitive
+inline int label2index(const std::string& label) {
+    if (label.empty() || label.size() > 6) return -1;
+    int ret = 0;
+    for (char c : label) {
+        if (is_lowercase(c)) {
+            ret = ret * 26 + (c - 'a' + 1);
+        } else if (is_uppercase(c)) {
+            ret = ret * 26 + (c - 'A' + 1);
+        } else {
+            return -1;
+        }
+    }
+    return ret - 1;
+}
+inline size_t label_length(size_t num) {
+    return num == 0 ? 1 : index2label(num - 1).size();
+}
+
 inline BoardSize cmd_get_size_helper() {
     cmd_clear();
     std::cout << HELPER_SELECT_SIZE << "\n";
@@ -266,6 +519,8 @@ inline BoardSize cmd_get_size_helper() {
             case 1 : return BoardSize::Small;
             case 2 : return BoardSize::Middle;
             case 3 : return BoardSize::Large;
+            case 4 : return BoardSize::Custom;
+            case 5 : return BoardSize::Infinite;
             default : {
                 std::cout << HELPER_INVALIDSIZE_3 << "\n";
                 size = -3; continue;
@@ -274,6 +529,33 @@ inline BoardSize cmd_get_size_helper() {
     }
     return BoardSize::Large;
 }
+struct CustomConfig {
+    size_t height;
+    size_t width;
+    float mine_ratio;
+};  // endof struct CustomConfig
+inline CustomConfig cmd_get_custom_helper() {
+    CustomConfig config{0, 0, MINE_POS_RATIO};
+    while (true) {
+        std::cout << HELPER_CUSTOM_HEIGHT << "\n";
+        std::cin >> config.height;
+        std::cout << HELPER_CUSTOM_WIDTH << "\n";
+        std::cin >> config.width;
+        std::cout << HELPER_CUSTOM_RATIO << "\n";
+        std::cin >> config.mine_ratio;
+        if (std::cin.eof()) {
+            exit(0);
+        } else if (!std::cin) {
+            std::cin.clear();
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        } else if (config.height > 0 && config.height <= CUSTOM_MAX_HEIGHT
+                   && config.width > 0 && config.width <= CUSTOM_MAX_WIDTH
+                   && config.mine_ratio >= eps && config.mine_ratio <= 0.9F) {
+            return config;
+        }
+        std::cout << HELPER_INVALID_CUSTOM << "\n";
+    }
+}
 inline GameMode  cmd_get_mode_helper() {
     cmd_clear();
     std::cout << HELPER_SELECT_MODE << "\n";
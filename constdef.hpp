@@ -10,6 +10,41 @@ namespace mfwu {
 constexpr const char* CMD_CLEAR = "\033[2J\033[1;1H";
 inline void cmd_clear() { std::cout << CMD_CLEAR; }
 constexpr float MINE_POS_RATIO = 0.2F;
+// custom boards, see BoardDims<BoardSize::Custom>
+constexpr size_t CUSTOM_MAX_HEIGHT = 4096;
+constexpr size_t CUSTOM_MAX_WIDTH  = 4096;
+// larger boards skip the mine layout in the log
+constexpr size_t MINE_LOG_MAX_TILES = 4096;
+// probabilities this close to 0 / 1 count as certain, see SolverRobot
+constexpr double SOLVER_EPS = 1e-9;
+// the robots' thread pool, see ThreadPool.hpp and FrontierSolver
+constexpr size_t SOLVER_POOL_WORKERS = 0;       // 0: one less than the cores
+constexpr size_t SOLVER_PARALLEL_MIN_VARS = 32; // smaller frontiers stay on the caller
+constexpr size_t SOLVER_SPLIT_MIN_VARS = 24;    // larger components split into subtrees
+constexpr size_t SOLVER_SPLIT_TASKS = 8;        // subtrees per thread
+constexpr size_t SOLVER_ENDGAME_UNKNOWNS = 64;  // exact over the mine count from here down
+// SolverRobot's time for one solve, half of it for the exact search,
+// the rest to sample the components it could not finish; 0: no limit
+constexpr size_t SOLVER_MOVE_BUDGET_US = 5000;
+constexpr size_t SOLVER_MIN_SAMPLES = 64;       // paths per sampled component, even late
+// the background solver of HumanPlayer, see HintEngine.hpp
+constexpr size_t HINT_MAX_TILES = 1 << 16;      // larger boards get no hints
+constexpr size_t HINT_BUDGET_US = 200000;       // for one position
+// initial bytes of the archive's packed frame arena
+constexpr size_t ARCHIVE_ARENA_INIT = 64 * 1024;
+// infinite boards, see ChunkBoard.hpp
+constexpr size_t CHUNK_SIZE = 64;
+constexpr size_t CHUNK_WORLD_CHUNKS = 1 << 18;  // per side, 2^24 tiles
+constexpr size_t CHUNK_CACHE_CAPACITY = 256;    // chunks in memory, 4KB each
+constexpr size_t CHUNK_REVEAL_MAX = 1 << 20;    // tiles per flood fill
+constexpr size_t CHUNK_VIEW_HEIGHT = 20;
+constexpr size_t CHUNK_VIEW_WIDTH  = 26;
+constexpr const char* CHUNK_DIR = "./chunks";
+// no-guess boards, see NoGuess.hpp
+constexpr size_t NO_GUESS_MAX_TILES = 1 << 16;
+constexpr size_t NO_GUESS_MAX_ATTEMPTS = 1 << 20;  // then take a guessing board
+constexpr size_t NO_GUESS_POOL_CAPACITY = 8;       // ready seeds per board shape
+constexpr size_t NO_GUESS_POOL_WORKERS = 0;       // 0: half of the cores
 constexpr float eps = 0.01F;
 constexpr const time_t XQ4MS_TIMESTAMP = 1741792500;
 
@@ -23,15 +58,43 @@ constexpr const char* MENU_CMD1 = "\\MENU";
 constexpr const char* MENU_CMD2 = "\\M";
 constexpr const char* MENU_CMD3 = "\\menu";
 constexpr const char* XQ4MS_CMD = "\\XQ4MS";
+constexpr const char* UNDO_CMD1 = "\\UNDO";
+constexpr const char* UNDO_CMD2 = "\\U";
+constexpr const char* REDO_CMD1 = "\\REDO";
+constexpr const char* REDO_CMD2 = "\\Y";
+constexpr const char* HINT_CMD1 = "\\HINT";
+constexpr const char* HINT_CMD2 = "\\H";
+constexpr const char* VIEW_UP_CMD    = "\\W";
+constexpr const char* VIEW_LEFT_CMD  = "\\A";
+constexpr const char* VIEW_DOWN_CMD  = "\\S";
+constexpr const char* VIEW_RIGHT_CMD = "\\D";
 
 
 constexpr const char* HELPER_RETURN2MENU = "Key in \\RESTART or \\MENU or \\QUIT if you want";
+constexpr const char* HELPER_UNDO_REDO   = "Key in \\UNDO or \\REDO to take back or replay a move";
+constexpr const char* HELPER_NOTHING_TO_UNDO = "Nothing to undo";
+constexpr const char* HELPER_NOTHING_TO_REDO = "Nothing to redo";
+constexpr const char* HELPER_HINT        = "Key in \\HINT for a safe tile or the safest guess";
+constexpr const char* HELPER_NO_HINT     = "No hints on this board";
+constexpr const char* HELPER_HINT_NO_FIT = "No mine layout fits the board, a flag must be wrong";
+constexpr const char* HELPER_HINT_TIMEOUT = "No hint in time, the board is too open to solve";
+constexpr const char* HELPER_HEATMAP_LEGEND = "Mine probability: \033[42m safe \033[0m"
+                                              "\033[46m <25% \033[0m\033[43m <50% \033[0m"
+                                              "\033[45m <100% \033[0m\033[41m mine \033[0m";
 constexpr const char* HELPER_PLACE_TILE  = "Key in R(eveal)/F(lag) and a pair of character to play, \n"
-                                           "e.g., RAB for revealing the first row & the second col";
+                                           "e.g., RAB for revealing the first row & the second col, \n"
+                                           "or R<row>,<col> on larger boards, e.g., RAA,BC";
 constexpr const char* HELPER_SELECT_MODE = "Plz key in your game mode: \n"
                                            "A.1. Human (default), B.2. Robot";
 constexpr const char* HELPER_SELECT_SIZE = "Plz key in your scale of board: \n"
-                                           "A.1. Small (default), B.2. Middle, C.3. Large";
+                                           "A.1. Small (default), B.2. Middle, C.3. Large, D.4. Custom, E.5. Infinite";
+constexpr const char* HELPER_CUSTOM_HEIGHT = "Plz key in the height of board (1 ~ 4096): ";
+constexpr const char* HELPER_CUSTOM_WIDTH  = "Plz key in the width of board (1 ~ 4096): ";
+constexpr const char* HELPER_CUSTOM_RATIO  = "Plz key in the mine density (0.01 ~ 0.9, default 0.2): ";
+constexpr const char* HELPER_CHUNK_MOVE_VIEW = "Key in \\W/\\A/\\S/\\D to move the view";
+constexpr const char* HELPER_CHUNK_HUMAN_ONLY = "Robots do not play infinite boards, you are on";
+constexpr const char* HELPER_CHUNK_REVEAL_CAPPED = "The flood fill stopped at its limit, "
+                                                   "open the zeros at its edge by hand";
 constexpr const char* HELPER_PRESS_ANY_KEY = "Press any key to continue...";
 
 constexpr const char* HELPER_INVALIDMODE_1 = "Invalid mode selection: input includes multiple chars T.T \n"
@@ -41,13 +104,14 @@ constexpr const char* HELPER_INVALIDMODE_2 = "Invalid mode selection: input is n
 constexpr const char* HELPER_INVALIDMODE_3 = "Invalid mode selection: input is not in alternative options -.- \n"
                                              "Just key in A/B or 1/2";
 constexpr const char* HELPER_INVALIDSIZE_1 = "Invalid size selection: input includes multiple chars T.T \n"
-                                             "Just key in A/B/C or 1/2/3";
+                                             "Just key in A/B/C/D/E or 1/2/3/4/5";
 constexpr const char* HELPER_INVALIDSIZE_2 = "Invalid size selection: input is not a digit or character >.< \n"
-                                             "Just key in A/B/C or 1/2/3";
+                                             "Just key in A/B/C/D/E or 1/2/3/4/5";
 constexpr const char* HELPER_INVALIDSIZE_3 = "Invalid size selection: input is not in alternative options -.- \n"
-                                             "Just key in A/B/C or 1/2/3";
+                                             "Just key in A/B/C/D/E or 1/2/3/4/5";
 constexpr const char* HELPER_REVEALED_POSITION = "Invalid position: already revealed";
 constexpr const char* HELPER_INVALID_POSITION  = "Invalid position, plz try again";
+constexpr const char* HELPER_INVALID_CUSTOM    = "Invalid custom board, plz try again";
                                              
 constexpr const char* ERROR_NEW_GC = "An error occurs when we new GameController()";
 constexpr const char* ERROR_UNKNOWN_COMMAND_TYPE = "Unknown CommandType";
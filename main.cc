@@ -1,5 +1,9 @@
 // #define __GUI_MODE__
 #define __CMD_MODE__
+// boards solvable without guessing, verified in the background
+// #define __NO_GUESS_MODE__
+// \HINT also colors the board by mine probability
+// #define __HINT_HEATMAP__
 
 #ifdef __GUI_MODE__
 #undef __CMD_MODE__
@@ -10,6 +14,12 @@
 using namespace mfwu;
 
 int main() {
+#ifdef __NO_GUESS_MODE__
+    set_no_guess_mode(true);
+#endif  // __NO_GUESS_MODE__
+#ifdef __HINT_HEATMAP__
+    set_hint_heatmap(true);
+#endif  // __HINT_HEATMAP__
 
     while (true) {
 #ifdef __CMD_MODE__
@@ -22,8 +32,9 @@ int main() {
 #       define __Board__ GuiBoard
 #endif  // __CMD_MODE__
 
-        // using __ROBOT__ = DebugRobot;
-        using __ROBOT__ = HumanLikeRobot;
+// #       define __ROBOT__ DebugRobot
+// #       define __ROBOT__ SolverRobot
+#       define __ROBOT__ HumanLikeRobot
         
         std::unique_ptr<GameController_base> game = nullptr;
 
@@ -64,6 +75,34 @@ int main() {
                 gc_error_exit(size, mode);
             }
         } break;
+        case BoardSize::Custom : {
+#ifdef __CMD_MODE__
+            const CustomConfig config = cmd_get_custom_helper();
+#else  // __GUI_MODE__
+            const CustomConfig config{12, 9, MINE_POS_RATIO};
+#endif  // __CMD_MODE__
+            switch (mode) {
+            case GameMode::Human : {
+                game = std::make_unique<GameController<__BOARD__<BoardSize::Custom>, HumanPlayer>>(
+                    config.height, config.width, config.mine_ratio);
+            } break;
+            case GameMode::Robot : {
+                game = std::make_unique<GameController<__BOARD__<BoardSize::Custom>, __ROBOT__>>(
+                    config.height, config.width, config.mine_ratio);
+            } break;
+            default : 
+                gc_error_exit(size, mode);
+            }
+        } break;
+#ifdef __CMD_MODE__
+        case BoardSize::Infinite : {
+            if (mode == GameMode::Robot) {
+                std::cout << HELPER_CHUNK_HUMAN_ONLY << "\n";
+                sleep(1);
+            }
+            game = std::make_unique<GameController<ChunkBoard, HumanPlayer>>();
+        } break;
+#endif  // __CMD_MODE__
         default :
             gc_error_exit(size, mode);
         }
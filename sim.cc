@@ -0,0 +1,160 @@
+// headless robot games: no terminal, no log, no archive
+#define __NULL_LOG__
+#include "common.hpp"
+#include "GameController.hpp"
+using namespace mfwu;
+
+// Plays in silence. A robot stuck for a move asks get_command(), which
+// reveals a random covered tile here, so that every game comes to an end;
+// the robot counts that as a guess of its own, see RobotPlayer::num_of_guess().
+// reset() takes the seed queued by queue_seed(), so game k of a run is
+// the same game whichever thread plays it.
+template <BoardSize Size>
+class SimBoard final : public Board<Size> {
+public:
+    SimBoard() : Board<Size>() {}
+
+    void queue_seed(uint64_t seed) {
+        next_seed_ = seed;
+    }
+    void reset() override {
+        this->reseed(next_seed_);
+    }
+    void reseed(uint64_t seed) override {
+        Board<Size>::reseed(seed);
+        rng_.seed(~seed);  // not the stream the board or robot draws from
+        num_of_move_ = 0;
+        result_ = 0;
+    }
+    void update(const Command& cmd) override {
+        Board<Size>::update(cmd);
+        num_of_move_++;
+    }
+    Command get_command() override {
+        int row, col;
+        do {
+            row = rng_.bounded(this->height());
+            col = rng_.bounded(this->width());
+        } while (this->get_tile(row, col).get_cover() == Cover::REVEALED
+                 || this->get_tile(row, col).get_flag() == Flag::FLAG);
+        return {CommandType::REVEAL, {row, col}};
+    }
+    void show() const override {}
+    void show_mine_num() const override {}
+    void show_without_log() const override {}
+    void refresh() override {}
+    void winner_display(int res) const override {
+        result_ = res;
+    }
+
+    size_t num_of_move() const { return num_of_move_; }
+    // 1 for a failure, 2 for a victory, see Board::is_end()
+    int result() const { return result_; }
+
+private:
+    uint64_t next_seed_ = 0;
+    Xoshiro256 rng_;
+    size_t num_of_move_ = 0;
+    mutable int result_ = 0;
+};  // endof class SimBoard
+
+using sim_clock = std::chrono::steady_clock;
+
+struct GameResult {
+    bool win;
+    uint32_t moves;
+    uint32_t guesses;
+    float us;
+};  // endof struct GameResult
+
+// every worker keeps one board, robot and controller for all its games
+template <BoardSize Size, template <typename> class Robot_type>
+struct SimSlot {
+    std::shared_ptr<SimBoard<Size>> board = std::make_shared<SimBoard<Size>>();
+    GameController<SimBoard<Size>, Robot_type, NullArchive<SimBoard<Size>>> game{board};
+};  // endof struct SimSlot
+
+template <BoardSize Size, template <typename> class Robot_type>
+void sim(const char* name, size_t games, uint64_t seed, WorkStealingPool& pool) {
+    const size_t chunk = 64;
+    std::vector<GameResult> results(games);
+    std::vector<std::unique_ptr<SimSlot<Size, Robot_type>>> slots(pool.num_of_worker() + 1);
+    TaskGroup group;
+    auto start = sim_clock::now();
+    for (size_t first = 0; first < games; first += chunk) {
+        pool.submit(group, [&, first] {
+            auto& slot = slots[pool.current_slot()];
+            if (!slot) { slot = std::make_unique<SimSlot<Size, Robot_type>>(); }
+            for (size_t k = first; k < std::min(first + chunk, games); k++) {
+                auto game_start = sim_clock::now();
+                slot->board->queue_seed(seed + k);
+                slot->game.restart_game_init(GameStatus::NORMAL);
+                slot->game.start();
+                results[k] = {slot->board->result() == 2,
+                              static_cast<uint32_t>(slot->board->num_of_move()),
+                              static_cast<uint32_t>(slot->game.get_player().num_of_guess()),
+                              std::chrono::duration<float, std::micro>(
+                                  sim_clock::now() - game_start).count()};
+            }
+        });
+    }
+    pool.wait(group);
+    double seconds = std::chrono::duration<double>(sim_clock::now() - start).count();
+
+    size_t wins = 0, moves = 0, guesses = 0;
+    std::vector<float> us(games);
+    for (size_t k = 0; k < games; k++) {
+        wins += results[k].win;
+        moves += results[k].moves;
+        guesses += results[k].guesses;
+        us[k] = results[k].us;
+    }
+    std::sort(us.begin(), us.end());
+    auto percentile = [&us](double p) {
+        return us[std::min(us.size() - 1, static_cast<size_t>(p * us.size()))];
+    };
+    printf("%-8s win: %6.2f%%  moves: %7.1f  guesses: %5.2f  %9.0f games/s"
+           "  us p50/p90/p99/max: %8.0f %8.0f %8.0f %8.0f\n",
+           name, 100.0 * wins / games, static_cast<double>(moves) / games,
+           static_cast<double>(guesses) / games, games / seconds,
+           percentile(0.50), percentile(0.90), percentile(0.99), us.back());
+}
+
+// usage: ./sim [games per size] [threads] [seed]
+// the whole of arg as a number, false for anything else
+bool parse_number(const char* arg, uint64_t& value) {
+    if (*arg == '\0' || *arg == '-') { return false; }
+    char* end = nullptr;
+    errno = 0;
+    value = strtoull(arg, &end, 0);
+    return errno == 0 && *end == '\0';
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t games = 10000;
+    uint64_t threads = std::max(1U, std::thread::hardware_concurrency());
+    uint64_t seed = 1;
+    bool valid = argc <= 4;
+    if (argc > 1) { valid &= parse_number(argv[1], games); }
+    if (argc > 2) { valid &= parse_number(argv[2], threads); }
+    if (argc > 3) { valid &= parse_number(argv[3], seed); }
+    if (!valid || games == 0 || threads == 0) {
+        fprintf(stderr, "usage: %s [games per size] [threads] [seed]\n", argv[0]);
+        return 1;
+    }
+    // the games are parallel already
+    set_robot_pool(false);
+    // the caller runs tasks too
+    WorkStealingPool pool(threads - 1);
+    printf("%lu games per size on %lu threads, seed %lu\n", games, threads, seed);
+    printf("HumanLikeRobot:\n");
+    sim<BoardSize::Small, HumanLikeRobot>("Small", games, seed, pool);
+    sim<BoardSize::Middle, HumanLikeRobot>("Middle", games, seed, pool);
+    sim<BoardSize::Large, HumanLikeRobot>("Large", games, seed, pool);
+    // the solver's time budget per move makes these vary a little by load
+    printf("SolverRobot:\n");
+    sim<BoardSize::Small, SolverRobot>("Small", games, seed, pool);
+    sim<BoardSize::Middle, SolverRobot>("Middle", games, seed, pool);
+    sim<BoardSize::Large, SolverRobot>("Large", games, seed, pool);
+    return 0;
+}